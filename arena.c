@@ -0,0 +1,141 @@
+#include "arena.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#define ARENA_ALIGNMENT 16
+
+static SDL_malloc_func real_malloc;
+static SDL_calloc_func real_calloc;
+static SDL_realloc_func real_realloc;
+static SDL_free_func real_free;
+static _Thread_local int heap_allocations;
+
+static void *countingMalloc(size_t size) {
+    heap_allocations++;
+    return real_malloc(size);
+}
+
+static void *countingCalloc(size_t count, size_t size) {
+    heap_allocations++;
+    return real_calloc(count, size);
+}
+
+static void *countingRealloc(void *memory, size_t size) {
+    heap_allocations++;
+    return real_realloc(memory, size);
+}
+
+void installAllocationCounter(void) {
+    SDL_GetMemoryFunctions(&real_malloc, &real_calloc, &real_realloc, &real_free);
+    SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, real_free);
+}
+
+int heapAllocationCount(void) {
+    return heap_allocations;
+}
+
+static ArenaBlock *newBlock(size_t size, ArenaBlock *next) {
+    ArenaBlock *block = SDL_malloc(sizeof(ArenaBlock) + size);
+    if (block) {
+        block->next = next;
+        block->size = size;
+        block->used = 0;
+    }
+    return block;
+}
+
+int arenaInit(FrameArena *arena, size_t size) {
+    arena->frame_used = 0;
+    arena->peak = 0;
+    arena->block = newBlock(size, nullptr);
+    return arena->block ? 0 : -1;
+}
+
+void *arenaAlloc(FrameArena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+    ArenaBlock *block = arena->block;
+
+    if (block == nullptr || block->size - block->used < size) {
+        size_t block_size = block && block->size * 2 > size ? block->size * 2 : size * 2;
+        block = newBlock(block_size, block);
+        if (block == nullptr) {
+            return nullptr;
+        }
+        arena->block = block;
+    }
+
+    void *memory = block->data + block->used;
+    block->used += size;
+    arena->frame_used += size;
+    return memory;
+}
+
+char *arenaPrintf(FrameArena *arena, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = SDL_vsnprintf(nullptr, 0, format, args);
+    va_end(args);
+    if (length < 0) {
+        return nullptr;
+    }
+
+    char *text = arenaAlloc(arena, length + 1);
+    if (text) {
+        va_start(args, format);
+        SDL_vsnprintf(text, length + 1, format, args);
+        va_end(args);
+    }
+    return text;
+}
+
+void arenaReset(FrameArena *arena) {
+    if (arena->frame_used > arena->peak) {
+        arena->peak = arena->frame_used;
+    }
+    arena->frame_used = 0;
+
+    ArenaBlock *block = arena->block;
+    if (block && block->next) {
+        while (block) {
+            ArenaBlock *next = block->next;
+            SDL_free(block);
+            block = next;
+        }
+        arena->block = newBlock(arena->peak * 2, nullptr);
+    } else if (block) {
+        block->used = 0;
+    }
+}
+
+void arenaFree(FrameArena *arena) {
+    ArenaBlock *block = arena->block;
+    while (block) {
+        ArenaBlock *next = block->next;
+        SDL_free(block);
+        block = next;
+    }
+    arena->block = nullptr;
+}
+
+void beginFrame(FrameArena *arena, FrameStats *stats) {
+    arenaReset(arena);
+    stats->mark = heapAllocationCount();
+}
+
+void endFrame(FrameStats *stats) {
+    stats->frame_allocations = heapAllocationCount() - stats->mark;
+    stats->frames++;
+    if (stats->frame_allocations > 0) {
+        stats->allocating_frames++;
+        stats->last_allocating_frame = stats->frames;
+        stats->total_allocations += stats->frame_allocations;
+    }
+}
+
+void printFrameStats(const FrameArena *arena, const FrameStats *stats) {
+    printf("Render allocations: %llu frames, %llu allocating (last at frame %llu), %llu heap allocations, "
+           "arena peak %zu bytes\n",
+           (unsigned long long) stats->frames, (unsigned long long) stats->allocating_frames,
+           (unsigned long long) stats->last_allocating_frame, (unsigned long long) stats->total_allocations,
+           arena->peak);
+}
@@ -0,0 +1,51 @@
+#ifndef TEXTEDITOR_ARENA_H
+#define TEXTEDITOR_ARENA_H
+
+#include <SDL.h>
+#include <stddef.h>
+
+#define FRAME_ARENA_SIZE (256 * 1024)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *block;
+    size_t frame_used;
+    size_t peak;
+} FrameArena;
+
+typedef struct {
+    Uint64 frames;
+    Uint64 allocating_frames;
+    Uint64 last_allocating_frame;
+    Uint64 total_allocations;
+    int frame_allocations;
+    int mark;
+} FrameStats;
+
+void installAllocationCounter(void);
+
+int heapAllocationCount(void);
+
+int arenaInit(FrameArena *arena, size_t size);
+
+void *arenaAlloc(FrameArena *arena, size_t size);
+
+char *arenaPrintf(FrameArena *arena, const char *format, ...);
+
+void arenaReset(FrameArena *arena);
+
+void arenaFree(FrameArena *arena);
+
+void beginFrame(FrameArena *arena, FrameStats *stats);
+
+void endFrame(FrameStats *stats);
+
+void printFrameStats(const FrameArena *arena, const FrameStats *stats);
+
+#endif
@@ -0,0 +1,420 @@
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "edit.h"
+#include "filemap.h"
+#include "linesort.h"
+#include "utf8.h"
+
+static const char *const command_names[BATCH_COMMAND_COUNT] = {
+        "goto", "find", "type", "enter", "backspace", "delete", "left", "right", "up", "down", "word-left",
+        "word-right", "home", "end", "top", "bottom", "sort", "sort-numeric", "unique", "reverse", "shuffle"
+};
+
+static void freeCommands(Batch *batch) {
+    for (int i = 0; i < batch->command_count; i++) {
+        free(batch->commands[i].text);
+    }
+    free(batch->commands);
+    batch->commands = nullptr;
+    batch->command_count = 0;
+}
+
+static int parseCommand(BatchCommand *command, char *line) {
+    char *argument = strchr(line, ' ');
+    if (argument) {
+        *argument++ = '\0';
+    }
+    command->op = -1;
+    for (int i = 0; i < BATCH_COMMAND_COUNT; i++) {
+        if (strcmp(line, command_names[i]) == 0) {
+            command->op = i;
+        }
+    }
+    command->count = 1;
+    command->column = 1;
+    command->text = nullptr;
+
+    if (command->op == BATCH_FIND || command->op == BATCH_TYPE) {
+        if (argument == nullptr || *argument == '\0' || strlen(argument) >= MAX_LINE_LENGTH) {
+            return -1;
+        }
+        command->text = strdup(argument);
+        return command->text ? 0 : -1;
+    }
+    if (command->op == BATCH_GOTO) {
+        return argument && sscanf(argument, "%d %d", &command->count, &command->column) >= 1 ? 0 : -1;
+    }
+    if (command->op < 0 || (argument && sscanf(argument, "%d", &command->count) != 1)) {
+        return -1;
+    }
+    return command->count > 0 ? 0 : -1;
+}
+
+static int readScript(Batch *batch, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        printf("Batch Error: Could not open script %s\n", path);
+        return 1;
+    }
+
+    char line[MAX_LINE_LENGTH + 32];
+    int capacity = 0;
+    int line_number = 0;
+    int result = 0;
+    while (result == 0 && fgets(line, sizeof(line), file)) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+        if (strcmp(line, "repeat") == 0) {
+            batch->repeat = SDL_TRUE;
+            continue;
+        }
+        if (batch->command_count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            BatchCommand *commands = realloc(batch->commands, capacity * sizeof(BatchCommand));
+            if (commands == nullptr) {
+                result = 1;
+                break;
+            }
+            batch->commands = commands;
+        }
+        if (parseCommand(&batch->commands[batch->command_count], line) != 0) {
+            printf("Batch Error: %s:%d: bad command %s\n", path, line_number, line);
+            result = 1;
+            break;
+        }
+        batch->command_count++;
+    }
+    fclose(file);
+
+    SDL_bool finds = SDL_FALSE;
+    for (int i = 0; i < batch->command_count; i++) {
+        finds = finds || batch->commands[i].op == BATCH_FIND;
+    }
+    if (result == 0 && batch->repeat && !finds) {
+        printf("Batch Error: %s: repeat needs a find command\n", path);
+        result = 1;
+    }
+    return result;
+}
+
+static int flushBlock(Document *doc, char **block, int used, int available) {
+    int result = appendLines(doc, block, used);
+    for (int i = result == 0 ? used : 0; i < available; i++) {
+        freeLine(block[i]);
+    }
+    return result;
+}
+
+static int loadLines(Document *doc, const char *data, size_t size, SDL_bool *final_newline) {
+    clearDocument(doc);
+    *final_newline = size > 0 && data[size - 1] == '\n';
+    if (size > 0 && memchr(data, '\0', size)) {
+        return -1;
+    }
+
+    char *block[BATCH_LINE_BLOCK];
+    int used = 0;
+    int available = 0;
+    const char *end = data + size;
+    for (const char *line = data; line < end;) {
+        const char *newline = memchr(line, '\n', end - line);
+        size_t length = (newline ? newline : end) - line;
+        if (length >= MAX_LINE_LENGTH) {
+            flushBlock(doc, block, 0, available);
+            return -1;
+        }
+
+        char *target = doc->lines[0];
+        if (line != data) {
+            if (used == available) {
+                if (flushBlock(doc, block, used, available) != 0) {
+                    return -1;
+                }
+                used = 0;
+                available = allocLines(block, BATCH_LINE_BLOCK);
+                if (available == 0) {
+                    return -1;
+                }
+            }
+            target = block[used++];
+        }
+        memcpy(target, line, length);
+        target[length] = '\0';
+        line = newline ? newline + 1 : end;
+    }
+    return flushBlock(doc, block, used, available);
+}
+
+static int writeLines(Document *doc, const char *path, SDL_bool final_newline) {
+    size_t length = strlen(path);
+    char *temp_path = malloc(length + 5);
+    if (temp_path == nullptr) {
+        return -1;
+    }
+    snprintf(temp_path, length + 5, "%s.tmp", path);
+
+    FILE *file = fopen(temp_path, "w");
+    if (file == nullptr) {
+        free(temp_path);
+        return -1;
+    }
+    setvbuf(file, nullptr, _IOFBF, BATCH_WRITE_BUFFER);
+    for (int i = 0; i < doc->line_count; i++) {
+        fputs(doc->lines[i], file);
+        if (i + 1 < doc->line_count || final_newline) {
+            fputc('\n', file);
+        }
+    }
+    int result = ferror(file) ? -1 : 0;
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+
+#ifndef _WIN32
+    struct stat st;
+    if (result == 0 && stat(path, &st) == 0) {
+        chmod(temp_path, st.st_mode & 07777);
+    }
+#endif
+    if (result != 0 || rename(temp_path, path) != 0) {
+        remove(temp_path);
+        result = -1;
+    }
+    free(temp_path);
+    return result;
+}
+
+static SDL_bool findText(Document *doc, const char *text, int *cursor_pos, int *current_line) {
+    for (int line = *current_line; line < doc->line_count; line++) {
+        const char *start = doc->lines[line] + (line == *current_line ? *cursor_pos : 0);
+        const char *match = strstr(start, text);
+        if (match) {
+            *current_line = line;
+            *cursor_pos = match - doc->lines[line];
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+static int runCommand(const BatchCommand *command, Document *doc, int *cursor_pos, int *current_line) {
+    int length, line;
+    switch (command->op) {
+        case BATCH_GOTO:
+            *current_line = command->count <= doc->line_count ? command->count - 1 : doc->line_count - 1;
+            if (*current_line < 0) {
+                *current_line = 0;
+            }
+            length = strlen(doc->lines[*current_line]);
+            *cursor_pos = command->column <= length ? command->column - 1 : length;
+            if (*cursor_pos < 0) {
+                *cursor_pos = 0;
+            }
+            *cursor_pos = utf8Snap(doc->lines[*current_line], *cursor_pos);
+            return 0;
+        case BATCH_FIND:
+            return findText(doc, command->text, cursor_pos, current_line) ? 0 : 1;
+        case BATCH_TYPE:
+            if (strlen(doc->lines[*current_line]) + strlen(command->text) >= MAX_LINE_LENGTH) {
+                return -1;
+            }
+            handleTextInput(doc, command->text, cursor_pos, *current_line);
+            return 0;
+        case BATCH_TOP:
+            *current_line = 0;
+            *cursor_pos = 0;
+            return 0;
+        case BATCH_BOTTOM:
+            *current_line = doc->line_count - 1;
+            cmdRight(doc, cursor_pos, *current_line);
+            return 0;
+        case BATCH_HOME:
+            cmdLeft(cursor_pos);
+            return 0;
+        case BATCH_END:
+            cmdRight(doc, cursor_pos, *current_line);
+            return 0;
+        case BATCH_SORT:
+        case BATCH_SORT_NUMERIC:
+        case BATCH_UNIQUE:
+        case BATCH_REVERSE:
+        case BATCH_SHUFFLE:
+            if (runLineCommand(doc, LINES_SORT + command->op - BATCH_SORT, 0, doc->line_count, 1) != 0) {
+                return -1;
+            }
+            *current_line = 0;
+            *cursor_pos = 0;
+            return 0;
+    }
+
+    for (int i = 0; i < command->count; i++) {
+        switch (command->op) {
+            case BATCH_ENTER:
+                length = doc->line_count;
+                handleEnterKey(doc, current_line, cursor_pos);
+                if (doc->line_count == length) {
+                    return -1;
+                }
+                break;
+            case BATCH_BACKSPACE:
+                if (handleBackspace(doc, cursor_pos, current_line) != 0) {
+                    return -1;
+                }
+                break;
+            case BATCH_DELETE:
+                length = *cursor_pos;
+                line = *current_line;
+                moveCursorRight(doc, cursor_pos, current_line);
+                if (*cursor_pos == length && *current_line == line) {
+                    return 0;
+                }
+                if (handleBackspace(doc, cursor_pos, current_line) != 0) {
+                    return -1;
+                }
+                break;
+            case BATCH_LEFT:
+                moveCursorLeft(doc, cursor_pos, current_line);
+                break;
+            case BATCH_RIGHT:
+                moveCursorRight(doc, cursor_pos, current_line);
+                break;
+            case BATCH_UP:
+                moveCursorUp(doc, cursor_pos, current_line);
+                break;
+            case BATCH_DOWN:
+                moveCursorDown(doc, cursor_pos, current_line);
+                break;
+            case BATCH_WORD_LEFT:
+                optLeft(doc, cursor_pos, *current_line);
+                break;
+            case BATCH_WORD_RIGHT:
+                optRight(doc, cursor_pos, *current_line);
+                break;
+        }
+    }
+    return 0;
+}
+
+static int runScript(Batch *batch, Document *doc) {
+    int cursor_pos = 0;
+    int current_line = 0;
+    for (;;) {
+        int start_line = current_line;
+        int start_pos = cursor_pos;
+        for (int i = 0; i < batch->command_count; i++) {
+            int result = runCommand(&batch->commands[i], doc, &cursor_pos, &current_line);
+            if (result != 0) {
+                return batch->repeat && result > 0 ? 0 : result;
+            }
+        }
+        if (!batch->repeat || current_line < start_line ||
+            (current_line == start_line && cursor_pos <= start_pos)) {
+            return 0;
+        }
+    }
+}
+
+static int batchFile(Batch *batch, Document *doc, const char *path) {
+    FileMap map;
+    if (mapFile(&map, path) != 0) {
+        printf("Batch Error: Could not read %s\n", path);
+        return -1;
+    }
+    SDL_bool final_newline;
+    int result = loadLines(doc, map.data, map.size, &final_newline);
+    unmapFile(&map);
+    if (result != 0) {
+        printf("Batch Error: %s is binary or has lines of %d bytes or more\n", path, MAX_LINE_LENGTH);
+        return -1;
+    }
+
+    result = runScript(batch, doc);
+    if (result > 0) {
+        printf("Batch: %s has no match, left unchanged\n", path);
+        return 0;
+    }
+    if (result < 0) {
+        printf("Batch Error: %s: an edit does not fit in a line, left unchanged\n", path);
+        return -1;
+    }
+    if (!doc->modified) {
+        return 0;
+    }
+    if (writeLines(doc, path, final_newline) != 0) {
+        printf("Batch Error: Could not write %s\n", path);
+        return -1;
+    }
+    return 1;
+}
+
+static int batchWorker(void *data) {
+    BatchWorker *worker = data;
+    Batch *batch = worker->batch;
+    for (int index = SDL_AtomicAdd(&batch->next, 1); index < batch->file_count;
+         index = SDL_AtomicAdd(&batch->next, 1)) {
+        int result = batchFile(batch, &worker->doc, batch->files[index]);
+        SDL_AtomicIncRef(result > 0 ? &batch->changed : (result == 0 ? &batch->unchanged : &batch->failed));
+    }
+    return 0;
+}
+
+int runBatch(const char *script_path, char **files, int file_count) {
+    Batch batch = {0};
+    batch.files = files;
+    batch.file_count = file_count;
+    if (readScript(&batch, script_path) != 0) {
+        freeCommands(&batch);
+        return 1;
+    }
+
+    int thread_count = SDL_GetCPUCount();
+    if (thread_count > BATCH_MAX_THREADS) {
+        thread_count = BATCH_MAX_THREADS;
+    }
+    if (thread_count > file_count) {
+        thread_count = file_count;
+    }
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+    BatchWorker *workers = calloc(thread_count, sizeof(BatchWorker));
+    if (workers == nullptr) {
+        freeCommands(&batch);
+        return 1;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].batch = &batch;
+        if (initDocument(&workers[i].doc) != 0) {
+            thread_count = i;
+            break;
+        }
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 1; i < thread_count; i++) {
+        workers[i].thread = SDL_CreateThread(batchWorker, "batch", &workers[i]);
+    }
+    if (thread_count > 0) {
+        batchWorker(&workers[0]);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        if (workers[i].thread) {
+            SDL_WaitThread(workers[i].thread, nullptr);
+        }
+        freeDocument(&workers[i].doc);
+    }
+    double elapsed = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    printf("Batch: %d changed, %d unchanged, %d failed in %.1f ms on %d threads.\n",
+           SDL_AtomicGet(&batch.changed), SDL_AtomicGet(&batch.unchanged), SDL_AtomicGet(&batch.failed), elapsed,
+           thread_count);
+
+    free(workers);
+    freeCommands(&batch);
+    return thread_count == 0 || SDL_AtomicGet(&batch.failed) > 0 ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+#ifndef TEXTEDITOR_BATCH_H
+#define TEXTEDITOR_BATCH_H
+
+#include <SDL.h>
+#include "document.h"
+
+#define BATCH_MAX_THREADS 64
+#define BATCH_LINE_BLOCK 1024
+#define BATCH_WRITE_BUFFER (1 << 16)
+
+enum {
+    BATCH_GOTO,
+    BATCH_FIND,
+    BATCH_TYPE,
+    BATCH_ENTER,
+    BATCH_BACKSPACE,
+    BATCH_DELETE,
+    BATCH_LEFT,
+    BATCH_RIGHT,
+    BATCH_UP,
+    BATCH_DOWN,
+    BATCH_WORD_LEFT,
+    BATCH_WORD_RIGHT,
+    BATCH_HOME,
+    BATCH_END,
+    BATCH_TOP,
+    BATCH_BOTTOM,
+    BATCH_SORT,
+    BATCH_SORT_NUMERIC,
+    BATCH_UNIQUE,
+    BATCH_REVERSE,
+    BATCH_SHUFFLE,
+    BATCH_COMMAND_COUNT
+};
+
+typedef struct {
+    int op;
+    int count;
+    int column;
+    char *text;
+} BatchCommand;
+
+typedef struct {
+    BatchCommand *commands;
+    int command_count;
+    SDL_bool repeat;
+    char **files;
+    int file_count;
+    SDL_atomic_t next;
+    SDL_atomic_t changed;
+    SDL_atomic_t unchanged;
+    SDL_atomic_t failed;
+} Batch;
+
+typedef struct {
+    Batch *batch;
+    Document doc;
+    SDL_Thread *thread;
+} BatchWorker;
+
+int runBatch(const char *script_path, char **files, int file_count);
+
+#endif
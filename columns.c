@@ -0,0 +1,276 @@
+#include "columns.h"
+#include "swar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COLUMN_SNIFF_LINES 16
+
+static const char column_delimiters[] = {',', '\t', ';', '|'};
+
+static int scanField(const char *text, int pos, int length, char delimiter, int *width) {
+    Uint64 delimiters = SWAR_ONES * (unsigned char) delimiter;
+    Uint64 quotes = delimiter == '\t' ? 0 : SWAR_ONES * '"';
+    SDL_bool quoted = SDL_FALSE;
+    int cells = 0;
+    while (pos < length) {
+        if (pos + 8 <= length) {
+            Uint64 word;
+            memcpy(&word, text + pos, sizeof(word));
+            word = SDL_SwapLE64(word);
+            Uint64 stops = swarMatchBytes(word, quotes) | (quoted ? 0 : swarMatchBytes(word, delimiters)) |
+                           (word & SWAR_HIGHS);
+            int skip = stops ? (int) (((stops & (~stops + 1)) >> 7) * SWAR_BYTE_INDEX >> 56) : 8;
+            cells += skip;
+            pos += skip;
+            if (skip == 8) {
+                continue;
+            }
+        }
+        unsigned char c = (unsigned char) text[pos];
+        if (c == (unsigned char) delimiter && !quoted) {
+            break;
+        }
+        if (c == '"' && delimiter != '\t') {
+            quoted = !quoted;
+        }
+        cells += (c & 0xC0) != 0x80;
+        pos++;
+    }
+    *width = cells;
+    return pos;
+}
+
+static void measureBlock(ColumnBlock *block, char **lines, char delimiter) {
+    memset(block->widths, 0, sizeof(block->widths));
+    block->column_count = 0;
+    for (int i = 0; i < block->line_count; i++) {
+        const char *text = lines[block->first_line + i];
+        int length = strlen(text);
+        int column = 0;
+        for (int pos = 0;; pos++, column++) {
+            int width;
+            pos = scanField(text, pos, length, delimiter, &width);
+            if (width > block->widths[column]) {
+                block->widths[column] = width;
+            }
+            if (pos >= length) {
+                break;
+            }
+        }
+        if (column + 1 > block->column_count) {
+            block->column_count = column + 1;
+        }
+    }
+    block->dirty = SDL_FALSE;
+}
+
+static int columnWorker(void *data) {
+    ColumnTask *task = data;
+    for (int i = task->first_block; i < task->end_block; i++) {
+        if (task->view->blocks[i].dirty) {
+            measureBlock(&task->view->blocks[i], task->doc->lines, task->view->delimiter);
+        }
+    }
+    return 0;
+}
+
+static void measureDirtyBlocks(ColumnView *view, Document *doc, int thread_count) {
+    long dirty_lines = 0;
+    for (int i = 0; i < view->block_count; i++) {
+        dirty_lines += view->blocks[i].dirty ? view->blocks[i].line_count : 0;
+    }
+    int tasks_count = (int) (dirty_lines / COLUMN_PARALLEL_LINES) + 1;
+    if (tasks_count > thread_count) {
+        tasks_count = thread_count;
+    }
+    if (tasks_count > COLUMN_MAX_THREADS) {
+        tasks_count = COLUMN_MAX_THREADS;
+    }
+    if (tasks_count < 1) {
+        tasks_count = 1;
+    }
+
+    ColumnTask tasks[COLUMN_MAX_THREADS];
+    for (int i = 0; i < tasks_count; i++) {
+        tasks[i] = (ColumnTask) {view, doc, (int) ((long) view->block_count * i / tasks_count),
+                                 (int) ((long) view->block_count * (i + 1) / tasks_count), nullptr};
+    }
+    for (int i = 1; i < tasks_count; i++) {
+        tasks[i].thread = SDL_CreateThread(columnWorker, "columns", &tasks[i]);
+    }
+    for (int i = 0; i < tasks_count; i++) {
+        if (i == 0 || tasks[i].thread == nullptr) {
+            columnWorker(&tasks[i]);
+        }
+    }
+    for (int i = 1; i < tasks_count; i++) {
+        if (tasks[i].thread) {
+            SDL_WaitThread(tasks[i].thread, nullptr);
+        }
+    }
+}
+
+void initColumns(ColumnView *view) {
+    memset(view, 0, sizeof(*view));
+}
+
+void freeColumns(ColumnView *view) {
+    free(view->blocks);
+    initColumns(view);
+}
+
+void resetColumns(ColumnView *view) {
+    view->block_count = 0;
+    view->line_count = 0;
+    view->column_count = 0;
+    view->dirty = SDL_TRUE;
+}
+
+void openColumns(ColumnView *view, const char *path) {
+    resetColumns(view);
+    size_t length = strlen(path);
+    if (length > 4 && SDL_strcasecmp(path + length - 4, ".csv") == 0) {
+        view->delimiter = ',';
+    } else if (length > 4 && SDL_strcasecmp(path + length - 4, ".tsv") == 0) {
+        view->delimiter = '\t';
+    } else {
+        view->delimiter = '\0';
+    }
+    view->active = view->delimiter != '\0';
+}
+
+int toggleColumns(ColumnView *view, Document *doc) {
+    if (view->active) {
+        view->active = SDL_FALSE;
+        return 0;
+    }
+    if (view->delimiter == '\0') {
+        int best = 0;
+        for (int i = 0; i < doc->line_count && i < COLUMN_SNIFF_LINES; i++) {
+            for (size_t d = 0; d < sizeof(column_delimiters); d++) {
+                int count = 0;
+                for (const char *p = strchr(doc->lines[i], column_delimiters[d]); p; p = strchr(p + 1, *p)) {
+                    count++;
+                }
+                if (count > best) {
+                    best = count;
+                    view->delimiter = column_delimiters[d];
+                }
+            }
+        }
+        if (view->delimiter == '\0') {
+            return -1;
+        }
+    }
+    resetColumns(view);
+    view->active = SDL_TRUE;
+    return 0;
+}
+
+static int findBlock(const ColumnView *view, int line) {
+    int low = 0;
+    int high = view->block_count - 1;
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+        if (view->blocks[middle].first_line <= line) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+void columnsEdited(ColumnView *view, int first_line, int removed, int inserted) {
+    if (first_line >= view->line_count) {
+        return;
+    }
+    if (first_line + removed > view->line_count) {
+        removed = view->line_count - first_line;
+    }
+    int first_block = findBlock(view, first_line);
+    int end = first_line + removed;
+    for (int i = first_block; i < view->block_count && view->blocks[i].first_line <= end; i++) {
+        ColumnBlock *block = &view->blocks[i];
+        int from = first_line > block->first_line ? first_line : block->first_line;
+        int to = end < block->first_line + block->line_count ? end : block->first_line + block->line_count;
+        block->line_count -= to > from ? to - from : 0;
+        block->dirty = block->dirty || i == first_block || to > from;
+    }
+    view->blocks[first_block].line_count += inserted;
+    for (int i = first_block + 1; i < view->block_count; i++) {
+        view->blocks[i].first_line = view->blocks[i - 1].first_line + view->blocks[i - 1].line_count;
+    }
+    view->line_count += inserted - removed;
+    view->dirty = SDL_TRUE;
+}
+
+static int coverLines(ColumnView *view, int line_count) {
+    if (view->block_count > 0 && view->line_count < line_count) {
+        ColumnBlock *last = &view->blocks[view->block_count - 1];
+        int room = last->line_count < COLUMN_BLOCK_LINES ? COLUMN_BLOCK_LINES - last->line_count : 0;
+        int added = line_count - view->line_count < room ? line_count - view->line_count : room;
+        last->line_count += added;
+        last->dirty = SDL_TRUE;
+        view->line_count += added;
+    }
+    while (view->line_count < line_count) {
+        if (view->block_count == view->block_capacity) {
+            int capacity = view->block_capacity ? view->block_capacity * 2 : 64;
+            ColumnBlock *blocks = realloc(view->blocks, capacity * sizeof(ColumnBlock));
+            if (blocks == nullptr) {
+                return -1;
+            }
+            view->blocks = blocks;
+            view->block_capacity = capacity;
+        }
+        ColumnBlock *block = &view->blocks[view->block_count++];
+        block->first_line = view->line_count;
+        block->line_count = line_count - view->line_count < COLUMN_BLOCK_LINES ? line_count - view->line_count
+                                                                               : COLUMN_BLOCK_LINES;
+        block->dirty = SDL_TRUE;
+        view->line_count += block->line_count;
+    }
+    return 0;
+}
+
+int updateColumns(ColumnView *view, Document *doc, int thread_count) {
+    if (!view->dirty && view->line_count == doc->line_count) {
+        return 0;
+    }
+    if (view->line_count > doc->line_count) {
+        resetColumns(view);
+    }
+    if (coverLines(view, doc->line_count) != 0) {
+        printf("Error: Not enough memory for the column view.\n");
+        view->active = SDL_FALSE;
+        return -1;
+    }
+    measureDirtyBlocks(view, doc, thread_count);
+
+    int widths[COLUMN_MAX_COUNT] = {0};
+    view->column_count = 0;
+    for (int i = 0; i < view->block_count; i++) {
+        const ColumnBlock *block = &view->blocks[i];
+        for (int c = 0; c < block->column_count; c++) {
+            if (block->widths[c] > widths[c]) {
+                widths[c] = block->widths[c];
+            }
+        }
+        if (block->column_count > view->column_count) {
+            view->column_count = block->column_count;
+        }
+    }
+    view->offsets[0] = 0;
+    for (int c = 0; c < view->column_count; c++) {
+        view->offsets[c + 1] = view->offsets[c] + widths[c] + COLUMN_GAP;
+    }
+    view->dirty = SDL_FALSE;
+    return 0;
+}
+
+int columnFieldEnd(char delimiter, const char *text, int pos) {
+    int width;
+    return scanField(text, pos, strlen(text), delimiter, &width);
+}
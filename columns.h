@@ -0,0 +1,57 @@
+#ifndef TEXTEDITOR_COLUMNS_H
+#define TEXTEDITOR_COLUMNS_H
+
+#include <SDL.h>
+#include "document.h"
+
+#define COLUMN_BLOCK_LINES 1024
+#define COLUMN_MAX_COUNT MAX_LINE_LENGTH
+#define COLUMN_GAP 2
+#define COLUMN_MAX_THREADS 64
+#define COLUMN_PARALLEL_LINES 65536
+
+typedef struct {
+    int first_line;
+    int line_count;
+    int column_count;
+    SDL_bool dirty;
+    Uint8 widths[COLUMN_MAX_COUNT];
+} ColumnBlock;
+
+typedef struct {
+    ColumnBlock *blocks;
+    int block_count;
+    int block_capacity;
+    int line_count;
+    char delimiter;
+    SDL_bool active;
+    SDL_bool dirty;
+    int column_count;
+    int offsets[COLUMN_MAX_COUNT + 1];
+} ColumnView;
+
+typedef struct {
+    ColumnView *view;
+    Document *doc;
+    int first_block;
+    int end_block;
+    SDL_Thread *thread;
+} ColumnTask;
+
+void initColumns(ColumnView *view);
+
+void freeColumns(ColumnView *view);
+
+void openColumns(ColumnView *view, const char *path);
+
+int toggleColumns(ColumnView *view, Document *doc);
+
+void resetColumns(ColumnView *view);
+
+void columnsEdited(ColumnView *view, int first_line, int removed, int inserted);
+
+int updateColumns(ColumnView *view, Document *doc, int thread_count);
+
+int columnFieldEnd(char delimiter, const char *text, int pos);
+
+#endif
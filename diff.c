@@ -0,0 +1,514 @@
+#include "diff.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const Uint64 *a;
+    const Uint64 *b;
+    int *v1;
+    int *v2;
+    DiffResult *result;
+    long work;
+    SDL_bool failed;
+} DiffContext;
+
+typedef struct {
+    Uint64 hash;
+    int a;
+    int b;
+} AnchorSlot;
+
+Uint64 hashBytes(const char *data, size_t length) {
+    Uint64 hash = 0x9E3779B97F4A7C15ull ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        Uint64 word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < length; i++) {
+        hash = (hash ^ (Uint8) data[i]) * 0x100000001B3ull;
+    }
+    return hash ^ (hash >> 29);
+}
+
+Uint64 *hashLines(char **lines, int count) {
+    Uint64 *hashes = malloc((count > 0 ? count : 1) * sizeof(Uint64));
+    if (hashes == nullptr) {
+        return nullptr;
+    }
+    for (int i = 0; i < count; i++) {
+        hashes[i] = hashBytes(lines[i], strlen(lines[i]));
+    }
+    return hashes;
+}
+
+static void addHunk(DiffContext *ctx, int a_lo, int a_count, int b_lo, int b_count) {
+    DiffResult *result = ctx->result;
+    if (a_count == 0 && b_count == 0) {
+        return;
+    }
+    if (result->count > 0) {
+        DiffHunk *last = &result->hunks[result->count - 1];
+        if (last->old_start + last->old_count == a_lo && last->new_start + last->new_count == b_lo) {
+            last->old_count += a_count;
+            last->new_count += b_count;
+            return;
+        }
+    }
+    if (result->count == result->capacity) {
+        int capacity = result->capacity ? result->capacity * 2 : 64;
+        DiffHunk *hunks = realloc(result->hunks, capacity * sizeof(DiffHunk));
+        if (hunks == nullptr) {
+            ctx->failed = SDL_TRUE;
+            return;
+        }
+        result->hunks = hunks;
+        result->capacity = capacity;
+    }
+    result->hunks[result->count++] = (DiffHunk) {a_lo, a_count, b_lo, b_count};
+}
+
+static SDL_bool bisect(DiffContext *ctx, int a_lo, int a_hi, int b_lo, int b_hi, int *split_x, int *split_y) {
+    const Uint64 *a = ctx->a + a_lo;
+    const Uint64 *b = ctx->b + b_lo;
+    int n = a_hi - a_lo;
+    int m = b_hi - b_lo;
+    int max_d = (n + m + 1) / 2;
+    if (max_d > DIFF_MAX_COST) {
+        max_d = DIFF_MAX_COST;
+    }
+    int v_offset = max_d;
+    int v_length = 2 * max_d;
+    int *v1 = ctx->v1;
+    int *v2 = ctx->v2;
+    for (int i = 0; i < v_length + 2; i++) {
+        v1[i] = -1;
+        v2[i] = -1;
+    }
+    v1[v_offset + 1] = 0;
+    v2[v_offset + 1] = 0;
+
+    int delta = n - m;
+    SDL_bool front = delta % 2 != 0;
+    int k1_start = 0, k1_end = 0, k2_start = 0, k2_end = 0;
+    for (int d = 0; d < max_d && ctx->work > 0; d++) {
+        for (int k1 = -d + k1_start; k1 <= d - k1_end; k1 += 2) {
+            int k1_offset = v_offset + k1;
+            int x1;
+            if (k1 == -d || (k1 != d && v1[k1_offset - 1] < v1[k1_offset + 1])) {
+                x1 = v1[k1_offset + 1];
+            } else {
+                x1 = v1[k1_offset - 1] + 1;
+            }
+            int y1 = x1 - k1;
+            int snake_start = x1;
+            while (x1 < n && y1 < m && a[x1] == b[y1]) {
+                x1++;
+                y1++;
+            }
+            ctx->work -= 1 + x1 - snake_start;
+            v1[k1_offset] = x1;
+            if (x1 > n) {
+                k1_end += 2;
+            } else if (y1 > m) {
+                k1_start += 2;
+            } else if (front) {
+                int k2_offset = v_offset + delta - k1;
+                if (k2_offset >= 0 && k2_offset < v_length && v2[k2_offset] != -1 && x1 >= n - v2[k2_offset]) {
+                    *split_x = x1;
+                    *split_y = y1;
+                    return SDL_TRUE;
+                }
+            }
+        }
+
+        for (int k2 = -d + k2_start; k2 <= d - k2_end; k2 += 2) {
+            int k2_offset = v_offset + k2;
+            int x2;
+            if (k2 == -d || (k2 != d && v2[k2_offset - 1] < v2[k2_offset + 1])) {
+                x2 = v2[k2_offset + 1];
+            } else {
+                x2 = v2[k2_offset - 1] + 1;
+            }
+            int y2 = x2 - k2;
+            int snake_start = x2;
+            while (x2 < n && y2 < m && a[n - x2 - 1] == b[m - y2 - 1]) {
+                x2++;
+                y2++;
+            }
+            ctx->work -= 1 + x2 - snake_start;
+            v2[k2_offset] = x2;
+            if (x2 > n) {
+                k2_end += 2;
+            } else if (y2 > m) {
+                k2_start += 2;
+            } else if (!front) {
+                int k1_offset = v_offset + delta - k2;
+                if (k1_offset >= 0 && k1_offset < v_length && v1[k1_offset] != -1) {
+                    int x1 = v1[k1_offset];
+                    if (x1 >= n - x2) {
+                        *split_x = x1;
+                        *split_y = v_offset + x1 - k1_offset;
+                        return SDL_TRUE;
+                    }
+                }
+            }
+        }
+    }
+    return SDL_FALSE;
+}
+
+static void diffRange(DiffContext *ctx, int a_lo, int a_hi, int b_lo, int b_hi, SDL_bool patience);
+
+static SDL_bool patienceSplit(DiffContext *ctx, int a_lo, int a_hi, int b_lo, int b_hi) {
+    size_t size = 1;
+    while (size < 2 * (size_t) (a_hi - a_lo + b_hi - b_lo)) {
+        size <<= 1;
+    }
+    AnchorSlot *slots = calloc(size, sizeof(AnchorSlot));
+    int *anchor_a = malloc((a_hi - a_lo) * sizeof(int));
+    int *anchor_b = malloc((a_hi - a_lo) * sizeof(int));
+    int *tails = malloc((a_hi - a_lo) * sizeof(int));
+    int *prev = malloc((a_hi - a_lo) * sizeof(int));
+    if (!slots || !anchor_a || !anchor_b || !tails || !prev) {
+        free(slots);
+        free(anchor_a);
+        free(anchor_b);
+        free(tails);
+        free(prev);
+        return SDL_FALSE;
+    }
+
+    for (int i = a_lo; i < a_hi; i++) {
+        size_t slot = ctx->a[i] & (size - 1);
+        while ((slots[slot].a || slots[slot].b) && slots[slot].hash != ctx->a[i]) {
+            slot = (slot + 1) & (size - 1);
+        }
+        slots[slot].hash = ctx->a[i];
+        slots[slot].a = slots[slot].a == 0 ? i + 1 : -1;
+    }
+    for (int j = b_lo; j < b_hi; j++) {
+        size_t slot = ctx->b[j] & (size - 1);
+        while ((slots[slot].a || slots[slot].b) && slots[slot].hash != ctx->b[j]) {
+            slot = (slot + 1) & (size - 1);
+        }
+        slots[slot].hash = ctx->b[j];
+        slots[slot].b = slots[slot].b == 0 ? j + 1 : -1;
+    }
+
+    int anchors = 0;
+    for (int i = a_lo; i < a_hi; i++) {
+        size_t slot = ctx->a[i] & (size - 1);
+        while (slots[slot].hash != ctx->a[i]) {
+            slot = (slot + 1) & (size - 1);
+        }
+        if (slots[slot].a > 0 && slots[slot].b > 0) {
+            anchor_a[anchors] = i;
+            anchor_b[anchors] = slots[slot].b - 1;
+            anchors++;
+        }
+    }
+    free(slots);
+
+    int length = 0;
+    for (int i = 0; i < anchors; i++) {
+        int lo = 0, hi = length;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (anchor_b[tails[mid]] < anchor_b[i]) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        prev[i] = lo > 0 ? tails[lo - 1] : -1;
+        tails[lo] = i;
+        if (lo == length) {
+            length++;
+        }
+    }
+
+    if (length > 0) {
+        for (int i = tails[length - 1], k = length - 1; i >= 0; i = prev[i], k--) {
+            tails[k] = i;
+        }
+        int prev_a = a_lo, prev_b = b_lo;
+        ctx->work = DIFF_WORK_LIMIT;
+        for (int k = 0; k < length; k++) {
+            int i = tails[k];
+            diffRange(ctx, prev_a, anchor_a[i], prev_b, anchor_b[i], SDL_FALSE);
+            prev_a = anchor_a[i] + 1;
+            prev_b = anchor_b[i] + 1;
+        }
+        diffRange(ctx, prev_a, a_hi, prev_b, b_hi, SDL_FALSE);
+    }
+
+    free(anchor_a);
+    free(anchor_b);
+    free(tails);
+    free(prev);
+    return length > 0;
+}
+
+static void diffRange(DiffContext *ctx, int a_lo, int a_hi, int b_lo, int b_hi, SDL_bool patience) {
+    while (a_lo < a_hi && b_lo < b_hi && ctx->a[a_lo] == ctx->b[b_lo]) {
+        a_lo++;
+        b_lo++;
+    }
+    while (a_lo < a_hi && b_lo < b_hi && ctx->a[a_hi - 1] == ctx->b[b_hi - 1]) {
+        a_hi--;
+        b_hi--;
+    }
+    if (a_lo == a_hi || b_lo == b_hi) {
+        addHunk(ctx, a_lo, a_hi - a_lo, b_lo, b_hi - b_lo);
+        return;
+    }
+
+    int x, y;
+    if (bisect(ctx, a_lo, a_hi, b_lo, b_hi, &x, &y)) {
+        diffRange(ctx, a_lo, a_lo + x, b_lo, b_lo + y, SDL_FALSE);
+        diffRange(ctx, a_lo + x, a_hi, b_lo + y, b_hi, SDL_FALSE);
+    } else if (!patience || !patienceSplit(ctx, a_lo, a_hi, b_lo, b_hi)) {
+        addHunk(ctx, a_lo, a_hi - a_lo, b_lo, b_hi - b_lo);
+    }
+}
+
+int diffHashes(const Uint64 *a, int n, const Uint64 *b, int m, DiffResult *result) {
+    memset(result, 0, sizeof(*result));
+    DiffContext ctx = {a, b, nullptr, nullptr, result, DIFF_WORK_LIMIT, SDL_FALSE};
+    ctx.v1 = malloc((2 * DIFF_MAX_COST + 2) * sizeof(int));
+    ctx.v2 = malloc((2 * DIFF_MAX_COST + 2) * sizeof(int));
+    if (ctx.v1 && ctx.v2) {
+        diffRange(&ctx, 0, n, 0, m, SDL_TRUE);
+    } else {
+        ctx.failed = SDL_TRUE;
+    }
+    free(ctx.v1);
+    free(ctx.v2);
+    if (ctx.failed) {
+        freeDiff(result);
+        return -1;
+    }
+    return 0;
+}
+
+void freeDiff(DiffResult *result) {
+    free(result->hunks);
+    memset(result, 0, sizeof(*result));
+}
+
+int initMarkers(ChangeMarkers *markers) {
+    memset(markers, 0, sizeof(*markers));
+    markers->event_type = SDL_RegisterEvents(1);
+    if (markers->event_type == (Uint32) -1) {
+        printf("Markers Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
+
+void freeMarkers(ChangeMarkers *markers) {
+    free(markers->baseline);
+    free(markers->marks);
+    markers->baseline = nullptr;
+    markers->baseline_count = 0;
+    markers->marks = nullptr;
+    markers->mark_count = 0;
+    markers->dirty = SDL_FALSE;
+}
+
+int setBaseline(ChangeMarkers *markers, Document *doc) {
+    Uint64 *baseline = hashLines(doc->lines, doc->line_count);
+    if (baseline == nullptr) {
+        return -1;
+    }
+    free(markers->baseline);
+    markers->baseline = baseline;
+    markers->baseline_count = doc->line_count;
+    markers->mark_count = 0;
+    markers->dirty = SDL_FALSE;
+    return 0;
+}
+
+int patchBaseline(ChangeMarkers *markers, Document *doc, int first_line, int removed, int inserted) {
+    int count = markers->baseline_count - removed + inserted;
+    if (markers->baseline == nullptr || count != doc->line_count) {
+        return setBaseline(markers, doc);
+    }
+
+    Uint64 *baseline = markers->baseline;
+    if (inserted > removed) {
+        baseline = realloc(baseline, count * sizeof(Uint64));
+        if (baseline == nullptr) {
+            return setBaseline(markers, doc);
+        }
+    }
+    memmove(baseline + first_line + inserted, baseline + first_line + removed,
+            (markers->baseline_count - first_line - removed) * sizeof(Uint64));
+    for (int i = first_line; i < first_line + inserted; i++) {
+        baseline[i] = hashBytes(doc->lines[i], strlen(doc->lines[i]));
+    }
+    markers->baseline = baseline;
+    markers->baseline_count = count;
+    markers->mark_count = 0;
+    return 0;
+}
+
+void markEdited(ChangeMarkers *markers) {
+    markers->dirty = SDL_TRUE;
+    markers->edited_at = SDL_GetTicks64();
+}
+
+SDL_bool updateMarkers(ChangeMarkers *markers, Document *doc) {
+    if (!markers->dirty || markers->baseline == nullptr ||
+        SDL_GetTicks64() - markers->edited_at < MARKER_DELAY_MS) {
+        return SDL_FALSE;
+    }
+    markers->dirty = SDL_FALSE;
+
+    Uint64 *hashes = hashLines(doc->lines, doc->line_count);
+    Uint8 *marks = realloc(markers->marks, doc->line_count > 0 ? doc->line_count : 1);
+    DiffResult diff;
+    if (hashes == nullptr || marks == nullptr ||
+        diffHashes(markers->baseline, markers->baseline_count, hashes, doc->line_count, &diff) != 0) {
+        free(hashes);
+        if (marks) {
+            markers->marks = marks;
+        }
+        markers->mark_count = 0;
+        return SDL_FALSE;
+    }
+    free(hashes);
+
+    memset(marks, MARK_NONE, doc->line_count);
+    for (int i = 0; i < diff.count; i++) {
+        DiffHunk *hunk = &diff.hunks[i];
+        if (hunk->new_count == 0) {
+            int line = hunk->new_start > 0 ? hunk->new_start - 1 : 0;
+            if (line < doc->line_count && marks[line] == MARK_NONE) {
+                marks[line] = MARK_REMOVED;
+            }
+        } else {
+            memset(marks + hunk->new_start, hunk->old_count ? MARK_CHANGED : MARK_ADDED, hunk->new_count);
+        }
+    }
+    freeDiff(&diff);
+    markers->marks = marks;
+    markers->mark_count = doc->line_count;
+
+    SDL_Event event = {0};
+    event.type = markers->event_type;
+    SDL_PushEvent(&event);
+    return SDL_TRUE;
+}
+
+static int readDocument(Document *doc, const char *path) {
+    FILE *file = fopen(path, "rb");
+    Stream stream;
+    TextReader reader;
+    if (file == nullptr || openReadStream(&stream, file) != 0 || openTextReader(&reader, &stream) != 0) {
+        if (file) {
+            closeStream(&stream);
+            fclose(file);
+        }
+        return -1;
+    }
+    char buffer[MAX_LINE_LENGTH];
+    SDL_bool first = SDL_TRUE;
+    int result = 0;
+    while (result == 0 && readTextLine(&reader, buffer, MAX_LINE_LENGTH)) {
+        if (!first) {
+            result = insertLine(doc, doc->line_count);
+        }
+        if (result == 0) {
+            strcpy(doc->lines[doc->line_count - 1], buffer);
+        }
+        first = SDL_FALSE;
+    }
+    closeTextReader(&reader);
+    if (closeStream(&stream) != 0) {
+        result = -1;
+    }
+    fclose(file);
+    return result;
+}
+
+static int appendViewLine(CompareView *view, int mark, const char *format, ...) {
+    Document *lines = &view->lines;
+    if (view->marks != nullptr && insertLine(lines, lines->line_count) != 0) {
+        return -1;
+    }
+    Uint8 *marks = realloc(view->marks, lines->capacity);
+    if (marks == nullptr) {
+        return -1;
+    }
+    view->marks = marks;
+    marks[lines->line_count - 1] = mark;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(lines->lines[lines->line_count - 1], MAX_LINE_LENGTH, format, args);
+    va_end(args);
+    return 0;
+}
+
+int openCompareView(CompareView *view, Document *doc, const char *path) {
+    Document disk;
+    memset(view, 0, sizeof(*view));
+    if (initDocument(&view->lines) != 0) {
+        return -1;
+    }
+    if (initDocument(&disk) != 0 || readDocument(&disk, path) != 0) {
+        printf("Error: Could not read %s for comparison.\n", path);
+        freeDocument(&disk);
+        closeCompareView(view);
+        return -1;
+    }
+
+    Uint64 *old_hashes = hashLines(disk.lines, disk.line_count);
+    Uint64 *new_hashes = hashLines(doc->lines, doc->line_count);
+    DiffResult diff = {0};
+    int result = -1;
+    if (old_hashes && new_hashes &&
+        diffHashes(old_hashes, disk.line_count, new_hashes, doc->line_count, &diff) == 0) {
+        result = 0;
+        if (diff.count == 0) {
+            result = appendViewLine(view, MARK_NONE, "No differences from %s", path);
+        }
+        for (int i = 0; result == 0 && i < diff.count; i++) {
+            DiffHunk *hunk = &diff.hunks[i];
+            result = appendViewLine(view, MARK_HEADER, "@@ -%d,%d +%d,%d @@", hunk->old_start + 1, hunk->old_count,
+                                    hunk->new_start + 1, hunk->new_count);
+            for (int j = 0; result == 0 && j < hunk->old_count; j++) {
+                result = appendViewLine(view, MARK_REMOVED, "-%s", disk.lines[hunk->old_start + j]);
+            }
+            for (int j = 0; result == 0 && j < hunk->new_count; j++) {
+                result = appendViewLine(view, MARK_ADDED, "+%s", doc->lines[hunk->new_start + j]);
+            }
+        }
+        printf("Compared with %s: %d changed regions.\n", path, diff.count);
+    }
+
+    free(old_hashes);
+    free(new_hashes);
+    freeDiff(&diff);
+    freeDocument(&disk);
+    if (result != 0) {
+        printf("Error: Could not build the comparison view.\n");
+        closeCompareView(view);
+        return -1;
+    }
+    view->active = SDL_TRUE;
+    return 0;
+}
+
+void closeCompareView(CompareView *view) {
+    freeDocument(&view->lines);
+    free(view->marks);
+    view->marks = nullptr;
+    view->active = SDL_FALSE;
+}
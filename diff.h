@@ -0,0 +1,75 @@
+#ifndef TEXTEDITOR_DIFF_H
+#define TEXTEDITOR_DIFF_H
+
+#include <SDL.h>
+#include <stddef.h>
+#include "document.h"
+#include "scroll.h"
+
+#define DIFF_MAX_COST (1 << 15)
+#define DIFF_WORK_LIMIT (1L << 24)
+#define MARKER_DELAY_MS 250
+
+enum {
+    MARK_NONE,
+    MARK_ADDED,
+    MARK_CHANGED,
+    MARK_REMOVED,
+    MARK_HEADER
+};
+
+typedef struct {
+    int old_start;
+    int old_count;
+    int new_start;
+    int new_count;
+} DiffHunk;
+
+typedef struct {
+    DiffHunk *hunks;
+    int count;
+    int capacity;
+} DiffResult;
+
+typedef struct {
+    Uint64 *baseline;
+    int baseline_count;
+    Uint8 *marks;
+    int mark_count;
+    SDL_bool dirty;
+    Uint64 edited_at;
+    Uint32 event_type;
+} ChangeMarkers;
+
+typedef struct {
+    Document lines;
+    Uint8 *marks;
+    SDL_bool active;
+    ScrollOffset saved_scroll;
+} CompareView;
+
+Uint64 hashBytes(const char *data, size_t length);
+
+Uint64 *hashLines(char **lines, int count);
+
+int diffHashes(const Uint64 *a, int n, const Uint64 *b, int m, DiffResult *result);
+
+void freeDiff(DiffResult *result);
+
+int initMarkers(ChangeMarkers *markers);
+
+void freeMarkers(ChangeMarkers *markers);
+
+int setBaseline(ChangeMarkers *markers, Document *doc);
+
+int patchBaseline(ChangeMarkers *markers, Document *doc, int first_line, int removed, int inserted);
+
+void markEdited(ChangeMarkers *markers);
+
+SDL_bool updateMarkers(ChangeMarkers *markers, Document *doc);
+
+int openCompareView(CompareView *view, Document *doc, const char *path);
+
+void closeCompareView(CompareView *view);
+
+#endif
@@ -0,0 +1,141 @@
+#include "document.h"
+#include <stdlib.h>
+#include <string.h>
+#include "pool.h"
+
+#define INITIAL_LINE_CAPACITY 128
+
+static Pool line_pool;
+
+static Pool *linePool(void) {
+    if (line_pool.node_size == 0) {
+        poolInit(&line_pool, MAX_LINE_LENGTH);
+    }
+    return &line_pool;
+}
+
+int initDocument(Document *doc) {
+    doc->lines = nullptr;
+    doc->line_count = 0;
+    doc->capacity = 0;
+    doc->modified = 0;
+    initFolds(&doc->folds);
+    defaultTextFormat(&doc->format);
+    return insertLine(doc, 0);
+}
+
+void freeDocument(Document *doc) {
+    for (int i = 0; i < doc->line_count; i++) {
+        freeLine(doc->lines[i]);
+    }
+    free(doc->lines);
+    doc->lines = nullptr;
+    doc->line_count = 0;
+    doc->capacity = 0;
+    clearFolds(&doc->folds);
+}
+
+void clearDocument(Document *doc) {
+    for (int i = 1; i < doc->line_count; i++) {
+        freeLine(doc->lines[i]);
+    }
+    doc->line_count = 1;
+    doc->lines[0][0] = '\0';
+    doc->modified = 0;
+    clearFolds(&doc->folds);
+    defaultTextFormat(&doc->format);
+}
+
+char *allocLine(void) {
+    char *line = poolAlloc(linePool());
+    if (line) {
+        memset(line, 0, MAX_LINE_LENGTH);
+    }
+    return line;
+}
+
+int allocLines(char **lines, int count) {
+    int allocated = poolAllocMany(linePool(), (void **) lines, count);
+    for (int i = 0; i < allocated; i++) {
+        memset(lines[i], 0, MAX_LINE_LENGTH);
+    }
+    return allocated;
+}
+
+void freeLine(char *line) {
+    poolFree(linePool(), line);
+}
+
+int reserveLines(Document *doc, int count) {
+    if (count <= doc->capacity) {
+        return 0;
+    }
+
+    int capacity = doc->capacity ? doc->capacity : INITIAL_LINE_CAPACITY;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    char **lines = realloc(doc->lines, capacity * sizeof(char *));
+    if (lines == nullptr) {
+        return -1;
+    }
+    doc->lines = lines;
+    doc->capacity = capacity;
+    return 0;
+}
+
+int insertLine(Document *doc, int index) {
+    if (index < 0 || index > doc->line_count || reserveLines(doc, doc->line_count + 1) != 0) {
+        return -1;
+    }
+
+    char *line = allocLine();
+    if (line == nullptr) {
+        return -1;
+    }
+
+    memmove(&doc->lines[index + 1], &doc->lines[index], (doc->line_count - index) * sizeof(char *));
+    doc->lines[index] = line;
+    doc->line_count++;
+    foldReplace(&doc->folds, index, 0, 1);
+    return 0;
+}
+
+void removeLine(Document *doc, int index) {
+    if (index < 0 || index >= doc->line_count) {
+        return;
+    }
+
+    freeLine(doc->lines[index]);
+    memmove(&doc->lines[index], &doc->lines[index + 1], (doc->line_count - index - 1) * sizeof(char *));
+    doc->line_count--;
+    foldReplace(&doc->folds, index, 1, 0);
+}
+
+int appendLines(Document *doc, char **lines, int count) {
+    if (reserveLines(doc, doc->line_count + count) != 0) {
+        return -1;
+    }
+
+    memcpy(&doc->lines[doc->line_count], lines, count * sizeof(char *));
+    doc->line_count += count;
+    return 0;
+}
+
+int replaceLines(Document *doc, int index, int remove_count, char **lines, int count) {
+    if (index < 0 || remove_count < 0 || index + remove_count > doc->line_count ||
+        reserveLines(doc, doc->line_count - remove_count + count) != 0) {
+        return -1;
+    }
+
+    for (int i = index; i < index + remove_count; i++) {
+        freeLine(doc->lines[i]);
+    }
+    memmove(&doc->lines[index + count], &doc->lines[index + remove_count],
+            (doc->line_count - index - remove_count) * sizeof(char *));
+    memcpy(&doc->lines[index], lines, count * sizeof(char *));
+    doc->line_count += count - remove_count;
+    foldReplace(&doc->folds, index, remove_count, count);
+    return 0;
+}
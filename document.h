@@ -0,0 +1,40 @@
+#ifndef TEXTEDITOR_DOCUMENT_H
+#define TEXTEDITOR_DOCUMENT_H
+
+#include "fold.h"
+#include "encoding.h"
+
+#define MAX_LINE_LENGTH 115
+
+typedef struct {
+    char **lines;
+    int line_count;
+    int capacity;
+    int modified;
+    FoldTree folds;
+    TextFormat format;
+} Document;
+
+int initDocument(Document *doc);
+
+void freeDocument(Document *doc);
+
+void clearDocument(Document *doc);
+
+char *allocLine(void);
+
+int allocLines(char **lines, int count);
+
+void freeLine(char *line);
+
+int reserveLines(Document *doc, int count);
+
+int insertLine(Document *doc, int index);
+
+void removeLine(Document *doc, int index);
+
+int appendLines(Document *doc, char **lines, int count);
+
+int replaceLines(Document *doc, int index, int remove_count, char **lines, int count);
+
+#endif
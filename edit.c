@@ -0,0 +1,138 @@
+#include "edit.h"
+#include "utf8.h"
+#include <stdio.h>
+#include <string.h>
+
+void handleTextInput(Document *doc, const char *input, int *cursor_pos, int current_line) {
+    int len = strlen(doc->lines[current_line]);
+    int input_len = strlen(input);
+
+    if (len + input_len >= MAX_LINE_LENGTH) {
+        printf("Line buffer is full!\n");
+        return;
+    }
+
+    memmove(doc->lines[current_line] + *cursor_pos + input_len, doc->lines[current_line] + *cursor_pos, len - *cursor_pos + 1);
+    memcpy(doc->lines[current_line] + *cursor_pos, input, input_len);
+    *cursor_pos += input_len;
+    doc->modified = 1;
+}
+
+void handleEnterKey(Document *doc, int *current_line, int *cursor_pos) {
+    if (insertLine(doc, *current_line + 1) != 0) {
+        printf("Error: Could not allocate a new line.\n");
+        return;
+    }
+
+    strcpy(doc->lines[*current_line + 1], doc->lines[*current_line] + *cursor_pos);
+    doc->lines[*current_line][*cursor_pos] = '\0';
+    doc->modified = 1;
+
+    *cursor_pos = 0;
+
+    moveCursorDown(doc, cursor_pos, current_line);
+}
+
+int handleBackspace(Document *doc, int *cursor_pos, int *current_line) {
+    if (*cursor_pos > 0) {
+        int len = strlen(doc->lines[*current_line]);
+        int start = utf8Prev(doc->lines[*current_line], *cursor_pos);
+        memmove(doc->lines[*current_line] + start, doc->lines[*current_line] + *cursor_pos, len - *cursor_pos + 1);
+        *cursor_pos = start;
+        doc->modified = 1;
+    } else if (*current_line > 0) {
+        int prev_len = strlen(doc->lines[*current_line - 1]);
+        int cur_len = strlen(doc->lines[*current_line]);
+        if (prev_len + cur_len >= MAX_LINE_LENGTH) {
+            return -1;
+        }
+        removeFold(&doc->folds, *current_line - 1);
+        strcat(doc->lines[*current_line - 1], doc->lines[*current_line]);
+        *cursor_pos = prev_len;
+        removeLine(doc, *current_line);
+        (*current_line)--;
+        doc->modified = 1;
+    }
+    return 0;
+}
+
+void moveCursorLeft(Document *doc, int *cursor_pos, int *current_line) {
+    if (*cursor_pos > 0) {
+        *cursor_pos = utf8Prev(doc->lines[*current_line], *cursor_pos);
+    } else if (*current_line > 0) {
+        *current_line = prevVisibleLine(&doc->folds, *current_line);
+        *cursor_pos = strlen(doc->lines[*current_line]);
+    }
+}
+
+void moveCursorRight(Document *doc, int *cursor_pos, int *current_line) {
+    int len = strlen(doc->lines[*current_line]);
+    if (*cursor_pos < len) {
+        *cursor_pos = utf8Next(doc->lines[*current_line], *cursor_pos);
+    } else if (nextVisibleLine(&doc->folds, *current_line) < doc->line_count) {
+        *current_line = nextVisibleLine(&doc->folds, *current_line);
+        *cursor_pos = 0;
+    }
+}
+
+void moveCursorUp(Document *doc, int *cursor_pos, int *current_line) {
+    if (*current_line <= 0) {
+        *current_line = 0;
+        return;
+    }
+
+    *current_line = prevVisibleLine(&doc->folds, *current_line);
+    *cursor_pos = utf8Snap(doc->lines[*current_line], *cursor_pos);
+}
+
+void moveCursorDown(Document *doc, int *cursor_pos, int *current_line) {
+    if (*current_line >= doc->line_count - 1) {
+        *current_line = doc->line_count - 1;
+        return;
+    }
+
+    int next = nextVisibleLine(&doc->folds, *current_line);
+    if (next >= doc->line_count) {
+        return;
+    }
+    *current_line = next;
+    *cursor_pos = utf8Snap(doc->lines[*current_line], *cursor_pos);
+}
+
+void optLeft(Document *doc, int *cursor_pos, int current_line) {
+    int i = *cursor_pos - 1;
+
+    while (i >= 0 && doc->lines[current_line][i] == ' ') {
+        i--;
+    }
+
+    while (i >= 0 && doc->lines[current_line][i] != ' ') {
+        i--;
+    }
+
+    *cursor_pos = i + 1;
+}
+
+void optRight(Document *doc, int *cursor_pos, int current_line) {
+    int len = strlen(doc->lines[current_line]);
+    int i = *cursor_pos;
+
+    while (i < len && doc->lines[current_line][i] == ' ') {
+        i++;
+    }
+
+    while (i < len && doc->lines[current_line][i] != ' ') {
+        i++;
+    }
+
+    *cursor_pos = i;
+}
+
+void cmdRight(Document *doc, int *cursor_pos, int current_line) {
+    int len = strlen(doc->lines[current_line]);
+    *cursor_pos = len;
+}
+
+void cmdLeft(int *cursor_pos) {
+    *cursor_pos = 0;
+}
@@ -0,0 +1,28 @@
+#ifndef TEXTEDITOR_EDIT_H
+#define TEXTEDITOR_EDIT_H
+
+#include "document.h"
+
+void handleTextInput(Document *doc, const char *input, int *cursor_pos, int current_line);
+
+void handleEnterKey(Document *doc, int *current_line, int *cursor_pos);
+
+int handleBackspace(Document *doc, int *cursor_pos, int *current_line);
+
+void moveCursorLeft(Document *doc, int *cursor_pos, int *current_line);
+
+void moveCursorRight(Document *doc, int *cursor_pos, int *current_line);
+
+void moveCursorUp(Document *doc, int *cursor_pos, int *current_line);
+
+void moveCursorDown(Document *doc, int *cursor_pos, int *current_line);
+
+void optLeft(Document *doc, int *cursor_pos, int current_line);
+
+void optRight(Document *doc, int *cursor_pos, int current_line);
+
+void cmdRight(Document *doc, int *cursor_pos, int current_line);
+
+void cmdLeft(int *cursor_pos);
+
+#endif
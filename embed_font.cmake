@@ -0,0 +1,6 @@
+file(READ ${INPUT} hex HEX)
+string(LENGTH "${hex}" hex_length)
+math(EXPR size "${hex_length} / 2")
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+string(REGEX REPLACE "((0x..,){16})" "\\1\n" bytes "${bytes}")
+file(WRITE ${OUTPUT} "#include \"font.h\"\n\nconst unsigned char font_data[] = {\n${bytes}\n};\n\nconst unsigned long font_data_size = ${size};\n")
@@ -0,0 +1,331 @@
+#include "encoding.h"
+#include "utf8.h"
+#include "swar.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const encoding_names[] = {"UTF-8", "UTF-16LE", "UTF-16BE", "Latin-1"};
+static const char *const eol_names[EOL_COUNT] = {"LF", "CRLF", "CR"};
+
+void defaultTextFormat(TextFormat *format) {
+    *format = (TextFormat) {TEXT_UTF8, EOL_LF, SDL_FALSE, SDL_TRUE, SDL_FALSE, COMPRESSION_NONE};
+}
+
+SDL_bool plainTextFormat(const TextFormat *format) {
+    return format->encoding == TEXT_UTF8 && format->eol == EOL_LF && !format->bom && !format->mixed_eol &&
+           format->compression == COMPRESSION_NONE;
+}
+
+const char *encodingName(int encoding) {
+    return encoding_names[encoding];
+}
+
+const char *eolName(int eol) {
+    return eol_names[eol];
+}
+
+static size_t plainRun(const unsigned char *data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        Uint64 word;
+        memcpy(&word, data + i, sizeof(word));
+        if ((word & SWAR_HIGHS) | swarMatchBytes(word, SWAR_ONES * '\n') | swarMatchBytes(word, SWAR_ONES * '\r')) {
+            break;
+        }
+    }
+    while (i < size && data[i] < 0x80 && data[i] != '\n' && data[i] != '\r') {
+        i++;
+    }
+    return i;
+}
+
+static SDL_bool ensureBytes(TextReader *reader, size_t count) {
+    while (reader->length - reader->pos < count && !reader->eof) {
+        if (reader->pos > 0) {
+            memmove(reader->buffer, reader->buffer + reader->pos, reader->length - reader->pos);
+            reader->length -= reader->pos;
+            reader->pos = 0;
+        }
+        size_t got = readStream(reader->stream, reader->buffer + reader->length, TEXT_BUFFER_SIZE - reader->length);
+        reader->length += got;
+        reader->eof = got == 0;
+    }
+    return reader->length - reader->pos >= count;
+}
+
+static int unitSize(const TextReader *reader) {
+    return reader->format.encoding == TEXT_UTF16LE || reader->format.encoding == TEXT_UTF16BE ? 2 : 1;
+}
+
+static long unitAt(const TextReader *reader, size_t offset) {
+    if (reader->length - reader->pos < offset + unitSize(reader)) {
+        return -1;
+    }
+    const unsigned char *p = reader->buffer + reader->pos + offset;
+    switch (reader->format.encoding) {
+        case TEXT_UTF16LE:
+            return p[0] | p[1] << 8;
+        case TEXT_UTF16BE:
+            return p[0] << 8 | p[1];
+        default:
+            return p[0];
+    }
+}
+
+static long peekUnit(TextReader *reader) {
+    ensureBytes(reader, unitSize(reader));
+    return unitAt(reader, 0);
+}
+
+static int guessEncoding(const unsigned char *p, size_t size) {
+    size_t pairs = size / 2;
+    size_t even_zeros = 0;
+    size_t odd_zeros = 0;
+    for (size_t i = 0; i < pairs * 2; i += 2) {
+        even_zeros += p[i] == 0;
+        odd_zeros += p[i + 1] == 0;
+    }
+    if (pairs > 0 && odd_zeros * 5 >= pairs * 2 && even_zeros * 20 < pairs) {
+        return TEXT_UTF16LE;
+    }
+    if (pairs > 0 && even_zeros * 5 >= pairs * 2 && odd_zeros * 20 < pairs) {
+        return TEXT_UTF16BE;
+    }
+    return TEXT_UTF8;
+}
+
+static void detectEncoding(TextReader *reader) {
+    ensureBytes(reader, TEXT_DETECT_BYTES);
+    const unsigned char *p = reader->buffer;
+    size_t size = reader->length;
+    if (size >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+        reader->format.bom = SDL_TRUE;
+        reader->multibyte = SDL_TRUE;
+        reader->pos = 3;
+    } else if (size >= 2 && (p[0] == 0xFF && p[1] == 0xFE)) {
+        reader->format.encoding = TEXT_UTF16LE;
+        reader->format.bom = SDL_TRUE;
+        reader->pos = 2;
+    } else if (size >= 2 && (p[0] == 0xFE && p[1] == 0xFF)) {
+        reader->format.encoding = TEXT_UTF16BE;
+        reader->format.bom = SDL_TRUE;
+        reader->pos = 2;
+    } else {
+        reader->format.encoding = guessEncoding(p, size);
+    }
+}
+
+SDL_bool binaryText(const unsigned char *data, size_t size) {
+    if (size >= 2 && ((data[0] == 0xFF && data[1] == 0xFE) || (data[0] == 0xFE && data[1] == 0xFF))) {
+        return SDL_FALSE;
+    }
+    return guessEncoding(data, size) == TEXT_UTF8 && memchr(data, 0, size) != nullptr;
+}
+
+int openTextReader(TextReader *reader, Stream *stream) {
+    memset(reader, 0, sizeof(*reader));
+    defaultTextFormat(&reader->format);
+    reader->format.final_newline = SDL_FALSE;
+    reader->format.compression = stream->compression;
+    reader->stream = stream;
+    reader->buffer = malloc(TEXT_BUFFER_SIZE);
+    if (reader->buffer == nullptr) {
+        return -1;
+    }
+    detectEncoding(reader);
+    return 0;
+}
+
+static SDL_bool endLine(TextReader *reader, char *line, int length, SDL_bool terminated) {
+    line[length] = '\0';
+    reader->terminated = terminated;
+    return SDL_TRUE;
+}
+
+static SDL_bool readWideLine(TextReader *reader, char *line, int capacity) {
+    int length = 0;
+    while (ensureBytes(reader, 4) || reader->length - reader->pos >= 2) {
+        long unit = unitAt(reader, 0);
+        Uint32 codepoint = (Uint32) unit;
+        size_t consumed = 2;
+        if (unit == '\n' || unit == '\r') {
+            reader->pos += 2;
+            reader->pending_cr = unit == '\r';
+            reader->eol_count[EOL_LF] += unit == '\n';
+            return endLine(reader, line, length, SDL_TRUE);
+        }
+        if (unit >= 0xD800 && unit < 0xDC00) {
+            long low = unitAt(reader, 2);
+            if (low >= 0xDC00 && low < 0xE000) {
+                codepoint = 0x10000 + ((Uint32) (unit - 0xD800) << 10) + (Uint32) (low - 0xDC00);
+                consumed = 4;
+            } else {
+                codepoint = UTF8_REPLACEMENT;
+            }
+        } else if (unit >= 0xDC00 && unit < 0xE000) {
+            codepoint = UTF8_REPLACEMENT;
+        }
+
+        char encoded[4];
+        int size = utf8Encode(codepoint, encoded);
+        if (length + size > capacity - 1) {
+            return endLine(reader, line, length, SDL_FALSE);
+        }
+        memcpy(line + length, encoded, size);
+        length += size;
+        reader->pos += consumed;
+    }
+    reader->pos = reader->length;
+    return length > 0 ? endLine(reader, line, length, SDL_FALSE) : SDL_FALSE;
+}
+
+SDL_bool readTextLine(TextReader *reader, char *line, int capacity) {
+    if (reader->pending_cr) {
+        reader->pending_cr = SDL_FALSE;
+        if (peekUnit(reader) == '\n') {
+            reader->pos += unitSize(reader);
+            reader->eol_count[EOL_CRLF]++;
+        } else {
+            reader->eol_count[EOL_CR]++;
+        }
+    }
+    if (unitSize(reader) == 2) {
+        return readWideLine(reader, line, capacity);
+    }
+
+    int length = 0;
+    while (ensureBytes(reader, 1)) {
+        const unsigned char *p = reader->buffer + reader->pos;
+        size_t available = reader->length - reader->pos;
+        size_t room = (size_t) (capacity - 1 - length);
+        size_t limit = utf8Cut((const char *) p, available, room);
+        const unsigned char *newline = memchr(p, '\n', limit);
+        size_t span = newline ? (size_t) (newline - p) : limit;
+        size_t run = reader->format.encoding == TEXT_UTF8 && !memchr(p, '\r', span)
+                     ? utf8ValidPrefix(p, span, &reader->multibyte) : plainRun(p, span);
+        if (run == span && newline) {
+            memcpy(line + length, p, run);
+            reader->pos += run + 1;
+            reader->eol_count[EOL_LF]++;
+            return endLine(reader, line, length + (int) run, SDL_TRUE);
+        }
+        memcpy(line + length, p, run);
+        length += (int) run;
+        reader->pos += run;
+        if (length == capacity - 1) {
+            return endLine(reader, line, length, SDL_FALSE);
+        }
+        if (run == available) {
+            continue;
+        }
+
+        unsigned char c = p[run];
+        if (c == '\n' || c == '\r') {
+            reader->pos++;
+            reader->pending_cr = c == '\r';
+            reader->eol_count[EOL_LF] += c == '\n';
+            return endLine(reader, line, length, SDL_TRUE);
+        }
+
+        ensureBytes(reader, 4);
+        p = reader->buffer + reader->pos;
+        int size = reader->format.encoding == TEXT_UTF8 ? utf8SequenceLength(p, reader->length - reader->pos) : 0;
+        if (size > 0) {
+            reader->multibyte = SDL_TRUE;
+        } else if (reader->format.encoding == TEXT_UTF8 && !reader->multibyte) {
+            reader->format.encoding = TEXT_LATIN1;
+        }
+        if (reader->format.encoding == TEXT_LATIN1) {
+            if (length + 2 > capacity - 1) {
+                return endLine(reader, line, length, SDL_FALSE);
+            }
+            length += utf8Encode(p[0], line + length);
+            reader->pos++;
+            continue;
+        }
+        size = size > 0 ? size : 1;
+        if (length + size > capacity - 1) {
+            return endLine(reader, line, length, SDL_FALSE);
+        }
+        memcpy(line + length, p, size);
+        length += size;
+        reader->pos += size;
+    }
+    return length > 0 ? endLine(reader, line, length, SDL_FALSE) : SDL_FALSE;
+}
+
+void closeTextReader(TextReader *reader) {
+    if (reader->pending_cr) {
+        reader->eol_count[EOL_CR]++;
+        reader->pending_cr = SDL_FALSE;
+    }
+    int styles = 0;
+    for (int eol = 0; eol < EOL_COUNT; eol++) {
+        styles += reader->eol_count[eol] > 0;
+        if (reader->eol_count[eol] > reader->eol_count[reader->format.eol]) {
+            reader->format.eol = eol;
+        }
+    }
+    reader->format.mixed_eol = styles > 1;
+    reader->format.final_newline = reader->terminated;
+    free(reader->buffer);
+    reader->buffer = nullptr;
+}
+
+static void putUnit(Stream *stream, int encoding, Uint32 unit) {
+    unsigned char bytes[2] = {(unsigned char) (unit & 0xFF), (unsigned char) (unit >> 8)};
+    if (encoding == TEXT_UTF16BE) {
+        bytes[0] = (unsigned char) (unit >> 8);
+        bytes[1] = (unsigned char) (unit & 0xFF);
+    }
+    writeStream(stream, bytes, sizeof(bytes));
+}
+
+static void putCodepoint(Stream *stream, int encoding, Uint32 codepoint) {
+    if (encoding == TEXT_LATIN1) {
+        unsigned char byte = codepoint <= 0xFF ? (unsigned char) codepoint : '?';
+        writeStream(stream, &byte, 1);
+    } else if (codepoint >= 0x10000) {
+        putUnit(stream, encoding, 0xD800 + ((codepoint - 0x10000) >> 10));
+        putUnit(stream, encoding, 0xDC00 + ((codepoint - 0x10000) & 0x3FF));
+    } else {
+        putUnit(stream, encoding, codepoint);
+    }
+}
+
+int writeTextStart(Stream *stream, const TextFormat *format) {
+    if (format->bom) {
+        if (format->encoding == TEXT_UTF8) {
+            writeStream(stream, "\xEF\xBB\xBF", 3);
+        } else if (format->encoding != TEXT_LATIN1) {
+            putUnit(stream, format->encoding, 0xFEFF);
+        }
+    }
+    return stream->failed ? -1 : 0;
+}
+
+int writeTextLine(Stream *stream, const TextFormat *format, const char *line, SDL_bool terminate) {
+    const char *eol = format->eol == EOL_CRLF ? "\r\n" : (format->eol == EOL_CR ? "\r" : "\n");
+    int length = strlen(line);
+    if (format->encoding == TEXT_UTF8) {
+        writeStream(stream, line, length);
+        if (terminate) {
+            writeStream(stream, eol, strlen(eol));
+        }
+        return stream->failed ? -1 : 0;
+    }
+
+    for (int i = 0; i < length;) {
+        int size;
+        Uint32 codepoint = utf8Decode(line + i, length - i, &size);
+        if (codepoint == UTF8_REPLACEMENT && size == 1 && format->encoding == TEXT_LATIN1) {
+            codepoint = (unsigned char) line[i];
+        }
+        putCodepoint(stream, format->encoding, codepoint);
+        i += size;
+    }
+    for (; terminate && *eol; eol++) {
+        putCodepoint(stream, format->encoding, (unsigned char) *eol);
+    }
+    return stream->failed ? -1 : 0;
+}
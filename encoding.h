@@ -0,0 +1,66 @@
+#ifndef TEXTEDITOR_ENCODING_H
+#define TEXTEDITOR_ENCODING_H
+
+#include <SDL.h>
+#include "stream.h"
+
+#define TEXT_BUFFER_SIZE (1 << 20)
+#define TEXT_DETECT_BYTES 4096
+
+enum {
+    TEXT_UTF8,
+    TEXT_UTF16LE,
+    TEXT_UTF16BE,
+    TEXT_LATIN1
+};
+
+enum {
+    EOL_LF,
+    EOL_CRLF,
+    EOL_CR,
+    EOL_COUNT
+};
+
+typedef struct {
+    int encoding;
+    int eol;
+    SDL_bool bom;
+    SDL_bool final_newline;
+    SDL_bool mixed_eol;
+    int compression;
+} TextFormat;
+
+typedef struct {
+    Stream *stream;
+    TextFormat format;
+    unsigned char *buffer;
+    size_t length;
+    size_t pos;
+    SDL_bool eof;
+    SDL_bool multibyte;
+    SDL_bool pending_cr;
+    SDL_bool terminated;
+    long eol_count[EOL_COUNT];
+} TextReader;
+
+void defaultTextFormat(TextFormat *format);
+
+SDL_bool plainTextFormat(const TextFormat *format);
+
+const char *encodingName(int encoding);
+
+const char *eolName(int eol);
+
+SDL_bool binaryText(const unsigned char *data, size_t size);
+
+int openTextReader(TextReader *reader, Stream *stream);
+
+SDL_bool readTextLine(TextReader *reader, char *line, int capacity);
+
+void closeTextReader(TextReader *reader);
+
+int writeTextStart(Stream *stream, const TextFormat *format);
+
+int writeTextLine(Stream *stream, const TextFormat *format, const char *line, SDL_bool terminate);
+
+#endif
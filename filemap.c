@@ -0,0 +1,85 @@
+#include "filemap.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+int mapFile(FileMap *map, const char *path) {
+    map->data = nullptr;
+    map->size = 0;
+    map->mapped = SDL_FALSE;
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size > 0) {
+        void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            map->data = data;
+            map->size = st.st_size;
+            map->mapped = SDL_TRUE;
+        }
+    }
+    close(fd);
+    if (map->mapped || st.st_size == 0) {
+        return 0;
+    }
+#endif
+
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return -1;
+    }
+    size_t capacity = 1 << 16;
+    char *data = malloc(capacity);
+    size_t size = 0;
+    size_t read;
+    while (data && (read = fread(data + size, 1, capacity - size, file)) > 0) {
+        size += read;
+        if (size == capacity) {
+            char *grown = realloc(data, capacity * 2);
+            if (grown == nullptr) {
+                free(data);
+                data = nullptr;
+                break;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+    }
+    fclose(file);
+    if (data == nullptr) {
+        return -1;
+    }
+    map->data = data;
+    map->size = size;
+    return 0;
+}
+
+void unmapFile(FileMap *map) {
+#ifndef _WIN32
+    if (map->mapped) {
+        munmap((void *) map->data, map->size);
+    } else
+#endif
+    {
+        free((void *) map->data);
+    }
+    map->data = nullptr;
+    map->size = 0;
+    map->mapped = SDL_FALSE;
+}
@@ -0,0 +1,17 @@
+#ifndef TEXTEDITOR_FILEMAP_H
+#define TEXTEDITOR_FILEMAP_H
+
+#include <SDL.h>
+#include <stddef.h>
+
+typedef struct {
+    const char *data;
+    size_t size;
+    SDL_bool mapped;
+} FileMap;
+
+int mapFile(FileMap *map, const char *path);
+
+void unmapFile(FileMap *map);
+
+#endif
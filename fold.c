@@ -0,0 +1,320 @@
+#include "fold.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int subtreeHidden(const FoldNode *node) {
+    return node ? node->hidden : 0;
+}
+
+static void shiftNode(FoldNode *node, int delta) {
+    node->start += delta;
+    node->end += delta;
+    node->max_end += delta;
+    node->lazy += delta;
+}
+
+static void push(FoldNode *node) {
+    if (node->lazy) {
+        if (node->left) {
+            shiftNode(node->left, node->lazy);
+        }
+        if (node->right) {
+            shiftNode(node->right, node->lazy);
+        }
+        node->lazy = 0;
+    }
+}
+
+static void pull(FoldNode *node) {
+    node->hidden = node->end - node->start + 1 + subtreeHidden(node->left) + subtreeHidden(node->right);
+    node->max_end = node->end;
+    if (node->left && node->left->max_end > node->max_end) {
+        node->max_end = node->left->max_end;
+    }
+    if (node->right && node->right->max_end > node->max_end) {
+        node->max_end = node->right->max_end;
+    }
+}
+
+static void splitStart(FoldNode *node, int key, FoldNode **left, FoldNode **right) {
+    if (node == nullptr) {
+        *left = nullptr;
+        *right = nullptr;
+        return;
+    }
+    push(node);
+    if (node->start < key) {
+        splitStart(node->right, key, &node->right, right);
+        *left = node;
+    } else {
+        splitStart(node->left, key, left, &node->left);
+        *right = node;
+    }
+    pull(node);
+}
+
+static void splitEnd(FoldNode *node, int key, FoldNode **left, FoldNode **right) {
+    if (node == nullptr) {
+        *left = nullptr;
+        *right = nullptr;
+        return;
+    }
+    push(node);
+    if (node->end < key) {
+        splitEnd(node->right, key, &node->right, right);
+        *left = node;
+    } else {
+        splitEnd(node->left, key, left, &node->left);
+        *right = node;
+    }
+    pull(node);
+}
+
+static FoldNode *merge(FoldNode *left, FoldNode *right) {
+    if (left == nullptr) {
+        return right;
+    }
+    if (right == nullptr) {
+        return left;
+    }
+    if (left->priority > right->priority) {
+        push(left);
+        left->right = merge(left->right, right);
+        pull(left);
+        return left;
+    }
+    push(right);
+    right->left = merge(left, right->left);
+    pull(right);
+    return right;
+}
+
+static void freeNodes(FoldNode *node) {
+    if (node) {
+        freeNodes(node->left);
+        freeNodes(node->right);
+        free(node);
+    }
+}
+
+void initFolds(FoldTree *folds) {
+    folds->root = nullptr;
+    folds->seed = 0x9E3779B9u;
+}
+
+void clearFolds(FoldTree *folds) {
+    freeNodes(folds->root);
+    folds->root = nullptr;
+}
+
+int addFold(FoldTree *folds, int first_hidden, int last_hidden) {
+    if (last_hidden < first_hidden) {
+        return -1;
+    }
+    FoldNode *node = malloc(sizeof(FoldNode));
+    if (node == nullptr) {
+        return -1;
+    }
+
+    FoldNode *left, *overlap, *right;
+    splitStart(folds->root, last_hidden + 2, &left, &right);
+    splitEnd(left, first_hidden, &left, &overlap);
+    if (overlap) {
+        FoldNode *first = overlap;
+        push(first);
+        while (first->left) {
+            first = first->left;
+            push(first);
+        }
+        if (first->start < first_hidden) {
+            first_hidden = first->start;
+        }
+        if (overlap->max_end > last_hidden) {
+            last_hidden = overlap->max_end;
+        }
+        freeNodes(overlap);
+    }
+
+    folds->seed ^= folds->seed << 13;
+    folds->seed ^= folds->seed >> 17;
+    folds->seed ^= folds->seed << 5;
+    *node = (FoldNode) {first_hidden, last_hidden, 0, 0, 0, folds->seed, nullptr, nullptr};
+    pull(node);
+    folds->root = merge(merge(left, node), right);
+    return 0;
+}
+
+SDL_bool removeFold(FoldTree *folds, int line) {
+    const FoldNode *fold = findFold(folds, line);
+    if (fold == nullptr) {
+        fold = findFold(folds, line + 1);
+        if (fold == nullptr || fold->start != line + 1) {
+            return SDL_FALSE;
+        }
+    }
+
+    int start = fold->start;
+    FoldNode *left, *middle, *right;
+    splitStart(folds->root, start, &left, &right);
+    splitStart(right, start + 1, &middle, &right);
+    freeNodes(middle);
+    folds->root = merge(left, right);
+    return SDL_TRUE;
+}
+
+const FoldNode *findFold(FoldTree *folds, int line) {
+    FoldNode *node = folds->root;
+    while (node) {
+        push(node);
+        if (node->start <= line && line <= node->end) {
+            return node;
+        }
+        node = node->left && node->left->max_end >= line ? node->left : node->right;
+    }
+    return nullptr;
+}
+
+int foldedAt(FoldTree *folds, int header) {
+    const FoldNode *fold = findFold(folds, header + 1);
+    return fold && fold->start == header + 1 ? fold->end - fold->start + 1 : 0;
+}
+
+void foldReplace(FoldTree *folds, int first, int removed, int inserted) {
+    if (folds->root == nullptr) {
+        return;
+    }
+    FoldNode *left, *touched, *right;
+    splitStart(folds->root, first + removed + 1, &left, &right);
+    splitEnd(left, first, &left, &touched);
+    freeNodes(touched);
+    if (right && inserted != removed) {
+        shiftNode(right, inserted - removed);
+    }
+    folds->root = merge(left, right);
+}
+
+static int collectNode(FoldNode *node, int (*ranges)[2], int max, int count) {
+    if (node == nullptr || count == max) {
+        return count;
+    }
+    push(node);
+    count = collectNode(node->left, ranges, max, count);
+    if (count < max) {
+        ranges[count][0] = node->start;
+        ranges[count][1] = node->end;
+        count++;
+    }
+    return collectNode(node->right, ranges, max, count);
+}
+
+int collectFolds(FoldTree *folds, int (*ranges)[2], int max) {
+    return collectNode(folds->root, ranges, max, 0);
+}
+
+int hiddenLineCount(const FoldTree *folds) {
+    return subtreeHidden(folds->root);
+}
+
+int rowToLine(FoldTree *folds, int row) {
+    int hidden = 0;
+    FoldNode *node = folds->root;
+    while (node) {
+        push(node);
+        int left_hidden = subtreeHidden(node->left);
+        if (row < node->start - hidden - left_hidden) {
+            node = node->left;
+        } else {
+            hidden += left_hidden + node->end - node->start + 1;
+            node = node->right;
+        }
+    }
+    return row + hidden;
+}
+
+int lineToRow(FoldTree *folds, int line) {
+    const FoldNode *fold = findFold(folds, line);
+    if (fold) {
+        line = fold->start - 1;
+    }
+    int hidden = 0;
+    FoldNode *node = folds->root;
+    while (node) {
+        push(node);
+        if (node->start > line) {
+            node = node->left;
+        } else {
+            hidden += subtreeHidden(node->left) + node->end - node->start + 1;
+            node = node->right;
+        }
+    }
+    return line - hidden;
+}
+
+int nextVisibleLine(FoldTree *folds, int line) {
+    const FoldNode *fold = findFold(folds, line + 1);
+    return fold ? fold->end + 1 : line + 1;
+}
+
+int prevVisibleLine(FoldTree *folds, int line) {
+    const FoldNode *fold = findFold(folds, line - 1);
+    return fold ? fold->start - 1 : line - 1;
+}
+
+static int indentOf(const char *text) {
+    int indent = 0;
+    for (; *text == ' ' || *text == '\t'; text++) {
+        indent += *text == '\t' ? 4 : 1;
+    }
+    return *text ? indent : -1;
+}
+
+static int closingLine(char **lines, int line_count, int line) {
+    int depth = 1;
+    SDL_bool quoted = SDL_FALSE;
+    for (int i = line + 1; i < line_count; i++) {
+        for (const char *c = lines[i]; *c; c++) {
+            if (quoted) {
+                if (*c == '\\' && c[1]) {
+                    c++;
+                } else if (*c == '"') {
+                    quoted = SDL_FALSE;
+                }
+            } else if (*c == '"') {
+                quoted = SDL_TRUE;
+            } else if (*c == '{' || *c == '[' || *c == '(') {
+                depth++;
+            } else if (*c == '}' || *c == ']' || *c == ')') {
+                if (--depth == 0) {
+                    return i;
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+int foldRegionEnd(char **lines, int line_count, int line) {
+    const char *text = lines[line];
+    int length = strlen(text);
+    while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t')) {
+        length--;
+    }
+    if (length > 0 && strchr("{[(", text[length - 1])) {
+        int close = closingLine(lines, line_count, line);
+        return close > line + 1 ? close - 1 : -1;
+    }
+
+    int base = indentOf(text);
+    int last = -1;
+    for (int i = line + 1; base >= 0 && i < line_count; i++) {
+        int indent = indentOf(lines[i]);
+        if (indent < 0) {
+            continue;
+        }
+        if (indent <= base) {
+            break;
+        }
+        last = i;
+    }
+    return last;
+}
@@ -0,0 +1,50 @@
+#ifndef TEXTEDITOR_FOLD_H
+#define TEXTEDITOR_FOLD_H
+
+#include <SDL.h>
+
+typedef struct FoldNode {
+    int start;
+    int end;
+    int hidden;
+    int max_end;
+    int lazy;
+    Uint32 priority;
+    struct FoldNode *left;
+    struct FoldNode *right;
+} FoldNode;
+
+typedef struct {
+    FoldNode *root;
+    Uint32 seed;
+} FoldTree;
+
+void initFolds(FoldTree *folds);
+
+void clearFolds(FoldTree *folds);
+
+int addFold(FoldTree *folds, int first_hidden, int last_hidden);
+
+SDL_bool removeFold(FoldTree *folds, int line);
+
+const FoldNode *findFold(FoldTree *folds, int line);
+
+int foldedAt(FoldTree *folds, int header);
+
+void foldReplace(FoldTree *folds, int first, int removed, int inserted);
+
+int hiddenLineCount(const FoldTree *folds);
+
+int rowToLine(FoldTree *folds, int row);
+
+int lineToRow(FoldTree *folds, int line);
+
+int nextVisibleLine(FoldTree *folds, int line);
+
+int prevVisibleLine(FoldTree *folds, int line);
+
+int foldRegionEnd(char **lines, int line_count, int line);
+
+int collectFolds(FoldTree *folds, int (*ranges)[2], int max);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef TEXTEDITOR_FONT_H
+#define TEXTEDITOR_FONT_H
+
+extern const unsigned char font_data[];
+
+extern const unsigned long font_data_size;
+
+#endif
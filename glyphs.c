@@ -0,0 +1,150 @@
+#include "glyphs.h"
+#include "utf8.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    SDL_Rect src;
+    SDL_Rect dst;
+} GlyphQuad;
+
+int initGlyphCache(GlyphCache *cache, SDL_Renderer *renderer, TTF_Font *font) {
+    memset(cache, 0, sizeof(*cache));
+    cache->renderer = renderer;
+    cache->font = font;
+    cache->cell_height = TTF_FontHeight(font);
+    cache->cell_width = cache->cell_height;
+    cache->warm_next = GLYPH_WARM_FIRST;
+
+    int rows = (GLYPH_COUNT + GLYPH_EXTRA_COUNT) / GLYPH_ATLAS_COLUMNS;
+    cache->atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                     cache->cell_width * GLYPH_ATLAS_COLUMNS, cache->cell_height * rows);
+    if (!cache->atlas) {
+        printf("Glyph atlas creation error: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_SetTextureBlendMode(cache->atlas, SDL_BLENDMODE_BLEND);
+    return 0;
+}
+
+void freeGlyphCache(GlyphCache *cache) {
+    if (cache->atlas) {
+        SDL_DestroyTexture(cache->atlas);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+static void loadGlyph(GlyphCache *cache, Glyph *glyph, Uint32 codepoint, int slot) {
+    SDL_Color white = {255, 255, 255, 255};
+    glyph->loaded = SDL_TRUE;
+
+    int minx, maxx, miny, maxy, advance;
+    if (TTF_GlyphMetrics32(cache->font, codepoint, &minx, &maxx, &miny, &maxy, &advance) == 0) {
+        glyph->advance = advance;
+    }
+
+    SDL_Surface *surface = TTF_RenderGlyph32_Solid(cache->font, codepoint, white);
+    if (!surface) {
+        return;
+    }
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surface);
+    if (!converted) {
+        printf("Glyph conversion error: %s\n", SDL_GetError());
+        return;
+    }
+
+    SDL_Rect cell = {(slot % GLYPH_ATLAS_COLUMNS) * cache->cell_width,
+                     (slot / GLYPH_ATLAS_COLUMNS) * cache->cell_height,
+                     converted->w < cache->cell_width ? converted->w : cache->cell_width,
+                     converted->h < cache->cell_height ? converted->h : cache->cell_height};
+    if (SDL_UpdateTexture(cache->atlas, &cell, converted->pixels, converted->pitch) == 0) {
+        glyph->src = cell;
+    }
+    if (glyph->advance == 0) {
+        glyph->advance = converted->w;
+    }
+    SDL_FreeSurface(converted);
+}
+
+const Glyph *getGlyph(GlyphCache *cache, Uint32 codepoint) {
+    if (codepoint < GLYPH_COUNT) {
+        Glyph *glyph = &cache->glyphs[codepoint];
+        if (!glyph->loaded) {
+            loadGlyph(cache, glyph, codepoint, (int) codepoint);
+        }
+        return glyph;
+    }
+
+    Uint32 index = codepoint * 2654435761u & (GLYPH_TABLE_SIZE - 1);
+    while (cache->extra_codepoints[index] != 0 && cache->extra_codepoints[index] != codepoint) {
+        index = (index + 1) & (GLYPH_TABLE_SIZE - 1);
+    }
+    Glyph *glyph = &cache->extra_glyphs[index];
+    if (cache->extra_codepoints[index] == 0) {
+        if (cache->extra_count == GLYPH_EXTRA_COUNT) {
+            return getGlyph(cache, '?');
+        }
+        cache->extra_codepoints[index] = codepoint;
+        loadGlyph(cache, glyph, codepoint, GLYPH_COUNT + cache->extra_count++);
+    }
+    return glyph;
+}
+
+static const Glyph *nextGlyph(GlyphCache *cache, const char *text, int length, int *pos) {
+    unsigned char c = (unsigned char) text[*pos];
+    if (c < 0x80) {
+        (*pos)++;
+        return cache->glyphs[c].loaded ? &cache->glyphs[c] : getGlyph(cache, c);
+    }
+    int size;
+    Uint32 codepoint = utf8Decode(text + *pos, length - *pos, &size);
+    *pos += size;
+    return getGlyph(cache, codepoint);
+}
+
+SDL_bool warmGlyphCache(GlyphCache *cache, int count) {
+    for (; count > 0 && cache->warm_next <= GLYPH_WARM_LAST; cache->warm_next++) {
+        if (!cache->glyphs[cache->warm_next].loaded) {
+            loadGlyph(cache, &cache->glyphs[cache->warm_next], cache->warm_next, cache->warm_next);
+            count--;
+        }
+    }
+    return cache->warm_next <= GLYPH_WARM_LAST;
+}
+
+int cellAdvance(GlyphCache *cache) {
+    return getGlyph(cache, '0')->advance;
+}
+
+int measureText(GlyphCache *cache, const char *text, int length) {
+    int width = 0;
+    for (int i = 0; i < length && text[i] != '\0';) {
+        width += nextGlyph(cache, text, length, &i)->advance;
+    }
+    return width;
+}
+
+int renderRun(SDL_Renderer *renderer, GlyphCache *cache, FrameArena *arena, const char *text, int x, int y) {
+    int length = strlen(text);
+    GlyphQuad *quads = arenaAlloc(arena, length * sizeof(GlyphQuad));
+    if (!quads && length > 0) {
+        return 1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < length;) {
+        const Glyph *glyph = nextGlyph(cache, text, length, &i);
+        if (glyph->src.w > 0) {
+            quads[count].src = glyph->src;
+            quads[count].dst = (SDL_Rect) {x, y, glyph->src.w, glyph->src.h};
+            count++;
+        }
+        x += glyph->advance;
+    }
+
+    for (int i = 0; i < count; i++) {
+        SDL_RenderCopy(renderer, cache->atlas, &quads[i].src, &quads[i].dst);
+    }
+    return 0;
+}
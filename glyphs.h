@@ -0,0 +1,49 @@
+#ifndef TEXTEDITOR_GLYPHS_H
+#define TEXTEDITOR_GLYPHS_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "arena.h"
+
+#define GLYPH_ATLAS_COLUMNS 32
+#define GLYPH_COUNT 256
+#define GLYPH_EXTRA_COUNT 1024
+#define GLYPH_TABLE_SIZE 2048
+#define GLYPH_WARM_FIRST 32
+#define GLYPH_WARM_LAST 126
+#define GLYPH_WARM_STEP 8
+
+typedef struct {
+    SDL_Rect src;
+    int advance;
+    SDL_bool loaded;
+} Glyph;
+
+typedef struct {
+    SDL_Renderer *renderer;
+    TTF_Font *font;
+    SDL_Texture *atlas;
+    int cell_width;
+    int cell_height;
+    int warm_next;
+    Glyph glyphs[GLYPH_COUNT];
+    Uint32 extra_codepoints[GLYPH_TABLE_SIZE];
+    Glyph extra_glyphs[GLYPH_TABLE_SIZE];
+    int extra_count;
+} GlyphCache;
+
+int initGlyphCache(GlyphCache *cache, SDL_Renderer *renderer, TTF_Font *font);
+
+void freeGlyphCache(GlyphCache *cache);
+
+SDL_bool warmGlyphCache(GlyphCache *cache, int count);
+
+const Glyph *getGlyph(GlyphCache *cache, Uint32 codepoint);
+
+int cellAdvance(GlyphCache *cache);
+
+int measureText(GlyphCache *cache, const char *text, int length);
+
+int renderRun(SDL_Renderer *renderer, GlyphCache *cache, FrameArena *arena, const char *text, int x, int y);
+
+#endif
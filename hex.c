@@ -0,0 +1,266 @@
+#include "hex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "encoding.h"
+
+static const char hex_digits[] = "0123456789abcdef";
+
+SDL_bool hexWanted(const char *path) {
+    unsigned char head[TEXT_DETECT_BYTES];
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return SDL_FALSE;
+    }
+    size_t got = fread(head, 1, sizeof(head), file);
+    fclose(file);
+    return binaryText(head, got);
+}
+
+int hexOpen(HexView *hex, const char *path) {
+    memset(hex, 0, sizeof(*hex));
+    if (mapFile(&hex->map, path) != 0) {
+        printf("Error: Could not open file for reading.\n");
+        return -1;
+    }
+    hex->path = strdup(path);
+    if (hex->path == nullptr) {
+        unmapFile(&hex->map);
+        return -1;
+    }
+    hex->offset_digits = hex->map.size > 0xFFFFFFFFULL ? 12 : 8;
+    printf("Opened %s as binary, %zu bytes.\n", path, hex->map.size);
+    return 0;
+}
+
+void hexClose(HexView *hex) {
+    if (hex->path) {
+        unmapFile(&hex->map);
+    }
+    free(hex->path);
+    free(hex->patches);
+    memset(hex, 0, sizeof(*hex));
+}
+
+static int findPatch(const HexView *hex, size_t offset) {
+    int low = 0;
+    int high = hex->patch_count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (hex->patches[middle].offset < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+Uint8 hexByte(const HexView *hex, size_t offset) {
+    int i = findPatch(hex, offset);
+    if (i < hex->patch_count && hex->patches[i].offset == offset) {
+        return hex->patches[i].value;
+    }
+    return (Uint8) hex->map.data[offset];
+}
+
+int hexSetByte(HexView *hex, size_t offset, Uint8 value) {
+    if (offset >= hex->map.size) {
+        return -1;
+    }
+    int i = findPatch(hex, offset);
+    SDL_bool found = i < hex->patch_count && hex->patches[i].offset == offset;
+    if (value == (Uint8) hex->map.data[offset]) {
+        if (found) {
+            memmove(&hex->patches[i], &hex->patches[i + 1], (hex->patch_count - i - 1) * sizeof(HexPatch));
+            hex->patch_count--;
+        }
+        return 0;
+    }
+    if (found) {
+        hex->patches[i].value = value;
+        return 0;
+    }
+    if (hex->patch_count == hex->patch_capacity) {
+        int capacity = hex->patch_capacity ? hex->patch_capacity * 2 : 64;
+        HexPatch *patches = realloc(hex->patches, capacity * sizeof(HexPatch));
+        if (patches == nullptr) {
+            printf("Error: Not enough memory to record the edit.\n");
+            return -1;
+        }
+        hex->patches = patches;
+        hex->patch_capacity = capacity;
+    }
+    memmove(&hex->patches[i + 1], &hex->patches[i], (hex->patch_count - i) * sizeof(HexPatch));
+    hex->patches[i] = (HexPatch) {offset, value};
+    hex->patch_count++;
+    return 0;
+}
+
+size_t hexRowCount(const HexView *hex) {
+    return (hex->map.size + HEX_ROW_BYTES - 1) / HEX_ROW_BYTES;
+}
+
+Uint32 hexFormatRow(const HexView *hex, size_t row, char *out) {
+    size_t start = row * HEX_ROW_BYTES;
+    int count = hex->map.size - start < HEX_ROW_BYTES ? (int) (hex->map.size - start) : HEX_ROW_BYTES;
+    int patch = findPatch(hex, start);
+    Uint32 patched = 0;
+    int digits = hex->offset_digits;
+    char *ascii = out + digits + 3 + HEX_ROW_BYTES * 3;
+
+    for (int i = digits - 1, shift = 0; i >= 0; i--, shift += 4) {
+        out[i] = hex_digits[(Uint64) start >> shift & 0xF];
+    }
+    memset(out + digits, ' ', HEX_ROW_BYTES * 3 + 3);
+    for (int i = 0; i < count; i++) {
+        Uint8 value = (Uint8) hex->map.data[start + i];
+        if (patch < hex->patch_count && hex->patches[patch].offset == start + i) {
+            value = hex->patches[patch++].value;
+            patched |= 1u << i;
+        }
+        out[digits + 2 + i * 3] = hex_digits[value >> 4];
+        out[digits + 3 + i * 3] = hex_digits[value & 0xF];
+        ascii[i] = value >= 0x20 && value < 0x7F ? (char) value : '.';
+    }
+    ascii[count] = '\0';
+    return patched;
+}
+
+int hexCursorColumn(const HexView *hex) {
+    int column = (int) (hex->cursor % HEX_ROW_BYTES);
+    if (hex->ascii) {
+        return hex->offset_digits + 3 + HEX_ROW_BYTES * 3 + column;
+    }
+    return hex->offset_digits + 2 + column * 3 + hex->low_nibble;
+}
+
+static void moveCursor(HexView *hex, long delta) {
+    if (delta < 0 && (size_t) -delta > hex->cursor) {
+        return;
+    }
+    if (delta > 0 && hex->cursor + delta >= hex->map.size) {
+        return;
+    }
+    hex->cursor += delta;
+    hex->low_nibble = SDL_FALSE;
+}
+
+void hexKey(HexView *hex, SDL_Keycode key) {
+    switch (key) {
+        case SDLK_LEFT:
+            moveCursor(hex, -1);
+            break;
+        case SDLK_RIGHT:
+            moveCursor(hex, 1);
+            break;
+        case SDLK_UP:
+            moveCursor(hex, -HEX_ROW_BYTES);
+            break;
+        case SDLK_DOWN:
+            moveCursor(hex, HEX_ROW_BYTES);
+            break;
+        case SDLK_HOME:
+            moveCursor(hex, -(long) (hex->cursor % HEX_ROW_BYTES));
+            break;
+        case SDLK_END:
+            moveCursor(hex, HEX_ROW_BYTES - 1 - (long) (hex->cursor % HEX_ROW_BYTES));
+            break;
+        case SDLK_TAB:
+            hex->ascii = !hex->ascii;
+            hex->low_nibble = SDL_FALSE;
+            break;
+        case SDLK_BACKSPACE:
+            if (hex->low_nibble) {
+                hex->low_nibble = SDL_FALSE;
+            } else {
+                moveCursor(hex, -1);
+            }
+            if (hex->cursor < hex->map.size) {
+                hexSetByte(hex, hex->cursor, (Uint8) hex->map.data[hex->cursor]);
+            }
+            break;
+    }
+}
+
+static int hexDigit(char c) {
+    const char *digit = c ? strchr(hex_digits, SDL_tolower(c)) : nullptr;
+    return digit ? (int) (digit - hex_digits) : -1;
+}
+
+void hexTextInput(HexView *hex, const char *input) {
+    for (; *input && hex->cursor < hex->map.size; input++) {
+        Uint8 value = hexByte(hex, hex->cursor);
+        if (hex->ascii) {
+            value = (Uint8) *input;
+        } else if (hexDigit(*input) < 0) {
+            continue;
+        } else if (hex->low_nibble) {
+            value = (value & 0xF0) | hexDigit(*input);
+        } else {
+            value = (value & 0x0F) | hexDigit(*input) << 4;
+        }
+        if (hexSetByte(hex, hex->cursor, value) != 0) {
+            return;
+        }
+        if (!hex->ascii && !hex->low_nibble) {
+            hex->low_nibble = SDL_TRUE;
+        } else if (hex->cursor + 1 < hex->map.size) {
+            moveCursor(hex, 1);
+        } else {
+            hex->low_nibble = SDL_FALSE;
+        }
+    }
+}
+
+static int seekFile(FILE *file, Uint64 offset) {
+#ifndef _WIN32
+    return fseeko(file, (off_t) offset, SEEK_SET);
+#else
+    return _fseeki64(file, (__int64) offset, SEEK_SET);
+#endif
+}
+
+int hexSave(HexView *hex) {
+    if (hex->patch_count == 0) {
+        printf("No changes to save in %s.\n", hex->path);
+        return 0;
+    }
+    FILE *file = fopen(hex->path, "r+b");
+    if (file == nullptr) {
+        printf("Error: Could not open %s for writing.\n", hex->path);
+        return -1;
+    }
+
+    Uint8 run[HEX_ROW_BYTES * 16];
+    int ranges = 0;
+    int result = 0;
+    for (int i = 0; i < hex->patch_count && result == 0;) {
+        int length = 0;
+        Uint64 start = hex->patches[i].offset;
+        while (i < hex->patch_count && length < (int) sizeof(run) && hex->patches[i].offset == start + length) {
+            run[length++] = hex->patches[i++].value;
+        }
+        if (seekFile(file, start) != 0 || fwrite(run, 1, length, file) != (size_t) length) {
+            result = -1;
+        }
+        ranges++;
+    }
+    if (fclose(file) != 0 || result != 0) {
+        printf("Error: Could not write %s.\n", hex->path);
+        return -1;
+    }
+
+    printf("Saved %d bytes in %d ranges to %s.\n", hex->patch_count, ranges, hex->path);
+    hex->patch_count = 0;
+    unmapFile(&hex->map);
+    if (mapFile(&hex->map, hex->path) != 0) {
+        printf("Error: Could not reopen %s.\n", hex->path);
+        hexClose(hex);
+        return -1;
+    }
+    if (hex->cursor >= hex->map.size) {
+        hex->cursor = hex->map.size > 0 ? hex->map.size - 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef TEXTEDITOR_HEX_H
+#define TEXTEDITOR_HEX_H
+
+#include <SDL.h>
+#include <stddef.h>
+#include "filemap.h"
+
+#define HEX_ROW_BYTES 16
+#define HEX_ROW_TEXT 96
+
+typedef struct {
+    Uint64 offset;
+    Uint8 value;
+} HexPatch;
+
+typedef struct {
+    char *path;
+    FileMap map;
+    HexPatch *patches;
+    int patch_count;
+    int patch_capacity;
+    size_t cursor;
+    SDL_bool low_nibble;
+    SDL_bool ascii;
+    int offset_digits;
+} HexView;
+
+SDL_bool hexWanted(const char *path);
+
+int hexOpen(HexView *hex, const char *path);
+
+void hexClose(HexView *hex);
+
+Uint8 hexByte(const HexView *hex, size_t offset);
+
+int hexSetByte(HexView *hex, size_t offset, Uint8 value);
+
+size_t hexRowCount(const HexView *hex);
+
+Uint32 hexFormatRow(const HexView *hex, size_t row, char *out);
+
+int hexCursorColumn(const HexView *hex);
+
+void hexKey(HexView *hex, SDL_Keycode key);
+
+void hexTextInput(HexView *hex, const char *input);
+
+int hexSave(HexView *hex);
+
+#endif
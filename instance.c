@@ -0,0 +1,290 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+#include "instance.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static int privateDirectory(const char *dir, SDL_bool create) {
+    if (create && mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    struct stat st;
+    return lstat(dir, &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid() && (st.st_mode & 077) == 0 ? 0 : -1;
+}
+
+static int socketAddress(struct sockaddr_un *address, SDL_bool create) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    char dir[sizeof(address->sun_path)];
+    if (runtime && runtime[0]) {
+        snprintf(dir, sizeof(dir), "%s", runtime);
+    } else {
+        snprintf(dir, sizeof(dir), "/tmp/texteditor-%d", (int) getuid());
+        if (privateDirectory(dir, create) != 0) {
+            return -1;
+        }
+    }
+    int length = snprintf(address->sun_path, sizeof(address->sun_path), "%s/%s", dir, INSTANCE_SOCKET_NAME);
+    return length > 0 && length < (int) sizeof(address->sun_path) ? 0 : -1;
+}
+
+static SDL_bool trustedPeer(int fd) {
+#ifdef __linux__
+    struct ucred cred;
+    socklen_t length = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &length) == 0 && cred.uid == getuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return getpeereid(fd, &uid, &gid) == 0 && uid == getuid();
+#endif
+}
+
+static void configureSocket(int fd) {
+    struct timeval timeout = {INSTANCE_TIMEOUT_MS / 1000, INSTANCE_TIMEOUT_MS % 1000 * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+static int readMessage(int fd, char *message, int size) {
+    int length = 0;
+    while (length < size - 1) {
+        ssize_t got = read(fd, message + length, size - 1 - length);
+        if (got <= 0) {
+            break;
+        }
+        length += got;
+        if (memchr(message + length - got, '\n', got)) {
+            break;
+        }
+    }
+    message[length] = '\0';
+    return length;
+}
+
+static int writeMessage(int fd, const char *message) {
+    size_t length = strlen(message);
+    while (length > 0) {
+        ssize_t written = send(fd, message, length, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return -1;
+        }
+        message += written;
+        length -= written;
+    }
+    return 0;
+}
+
+static void handleClient(Instance *instance, int client) {
+    char message[INSTANCE_MESSAGE_LENGTH];
+    configureSocket(client);
+    readMessage(client, message, sizeof(message));
+    message[strcspn(message, "\n")] = '\0';
+
+    if (strcmp(message, "ping") == 0) {
+        writeMessage(client, "ok\n");
+    } else if (strncmp(message, "open ", 5) == 0 || strcmp(message, "raise") == 0) {
+        SDL_Event event = {0};
+        event.type = instance->event_type;
+        event.user.data1 = message[0] == 'o' ? strdup(message + 5) : nullptr;
+        if (SDL_PushEvent(&event) <= 0) {
+            free(event.user.data1);
+            writeMessage(client, "error busy\n");
+        } else {
+            writeMessage(client, "ok\n");
+        }
+    } else if (strcmp(message, "query") == 0) {
+        char reply[INSTANCE_MESSAGE_LENGTH];
+        SDL_LockMutex(instance->lock);
+        snprintf(reply, sizeof(reply), "%s\t%d\t%d\t%d\n", instance->path ? instance->path : "-", instance->line,
+                 instance->column, instance->line_count);
+        SDL_UnlockMutex(instance->lock);
+        writeMessage(client, reply);
+    } else {
+        writeMessage(client, "error unknown request\n");
+    }
+}
+
+static int instanceWorker(void *data) {
+    Instance *instance = data;
+    while (!SDL_AtomicGet(&instance->stop)) {
+        struct pollfd listener = {instance->fd, POLLIN, 0};
+        if (poll(&listener, 1, INSTANCE_POLL_MS) <= 0) {
+            continue;
+        }
+        int client = accept(instance->fd, nullptr, nullptr);
+        if (client >= 0 && trustedPeer(client)) {
+            handleClient(instance, client);
+        }
+        if (client >= 0) {
+            close(client);
+        }
+    }
+    return 0;
+}
+
+int instanceRequest(const char *request, char *reply, int reply_size) {
+    struct sockaddr_un address;
+    if (socketAddress(&address, SDL_FALSE) != 0) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    configureSocket(fd);
+    int result = connect(fd, (struct sockaddr *) &address, sizeof(address)) == 0 && trustedPeer(fd) &&
+                 writeMessage(fd, request) == 0 && readMessage(fd, reply, reply_size) > 0 ? 0 : -1;
+    close(fd);
+    return result;
+}
+
+int instanceHandOver(const char *path) {
+    char request[INSTANCE_MESSAGE_LENGTH];
+    char reply[64];
+    char cwd[INSTANCE_MESSAGE_LENGTH / 2];
+    if (path == nullptr) {
+        snprintf(request, sizeof(request), "raise\n");
+    } else if (strcmp(path, "-") == 0 || strchr(path, '\n')) {
+        return -1;
+    } else if (path[0] == '/') {
+        snprintf(request, sizeof(request), "open %s\n", path);
+    } else if (getcwd(cwd, sizeof(cwd))) {
+        snprintf(request, sizeof(request), "open %s/%s\n", cwd, path);
+    } else {
+        return -1;
+    }
+    if (request[strlen(request) - 1] != '\n' || instanceRequest(request, reply, sizeof(reply)) != 0) {
+        return -1;
+    }
+    if (strncmp(reply, "ok", 2) != 0) {
+        printf("Instance Error: %s", reply);
+        return -1;
+    }
+    return 0;
+}
+
+int startInstance(Instance *instance) {
+    memset(instance, 0, sizeof(*instance));
+    struct sockaddr_un address;
+    if (socketAddress(&address, SDL_TRUE) != 0) {
+        printf("Instance Error: no private directory for the instance socket\n");
+        return 1;
+    }
+    char reply[8];
+    if (instanceRequest("ping\n", reply, sizeof(reply)) == 0) {
+        printf("Instance Error: another instance is already listening on %s\n", address.sun_path);
+        return 1;
+    }
+
+    instance->event_type = SDL_RegisterEvents(1);
+    instance->lock = SDL_CreateMutex();
+    if (instance->event_type == (Uint32) -1 || instance->lock == nullptr) {
+        printf("Instance Error: %s\n", SDL_GetError());
+        stopInstance(instance);
+        return 1;
+    }
+
+    unlink(address.sun_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t mask = umask(077);
+    SDL_bool bound = fd >= 0 && bind(fd, (struct sockaddr *) &address, sizeof(address)) == 0;
+    umask(mask);
+    if (!bound || chmod(address.sun_path, 0600) != 0 || listen(fd, 8) != 0) {
+        printf("Instance Error: could not listen on %s\n", address.sun_path);
+        if (bound) {
+            unlink(address.sun_path);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        stopInstance(instance);
+        return 1;
+    }
+    instance->fd = fd;
+    instance->socket_path = strdup(address.sun_path);
+    instance->thread = SDL_CreateThread(instanceWorker, "instance", instance);
+    if (instance->thread == nullptr) {
+        printf("SDL_CreateThread Error: %s\n", SDL_GetError());
+        stopInstance(instance);
+        return 1;
+    }
+    return 0;
+}
+
+void stopInstance(Instance *instance) {
+    SDL_AtomicSet(&instance->stop, 1);
+    if (instance->thread) {
+        SDL_WaitThread(instance->thread, nullptr);
+    }
+    if (instance->socket_path) {
+        close(instance->fd);
+        unlink(instance->socket_path);
+        free(instance->socket_path);
+    }
+    if (instance->lock) {
+        SDL_DestroyMutex(instance->lock);
+    }
+    free(instance->path);
+    memset(instance, 0, sizeof(*instance));
+}
+
+void instancePublish(Instance *instance, const char *path, int line, int column, int line_count) {
+    if (instance->lock == nullptr) {
+        return;
+    }
+    SDL_LockMutex(instance->lock);
+    if (path == nullptr || instance->path == nullptr || strcmp(path, instance->path) != 0) {
+        free(instance->path);
+        instance->path = path ? strdup(path) : nullptr;
+    }
+    instance->line = line;
+    instance->column = column;
+    instance->line_count = line_count;
+    SDL_UnlockMutex(instance->lock);
+}
+
+#else
+
+int instanceRequest(const char *request, char *reply, int reply_size) {
+    return -1;
+}
+
+int instanceHandOver(const char *path) {
+    return -1;
+}
+
+int startInstance(Instance *instance) {
+    memset(instance, 0, sizeof(*instance));
+    printf("Error: Single-instance mode is not supported on this platform.\n");
+    return 1;
+}
+
+void stopInstance(Instance *instance) {
+    memset(instance, 0, sizeof(*instance));
+}
+
+void instancePublish(Instance *instance, const char *path, int line, int column, int line_count) {
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef TEXTEDITOR_INSTANCE_H
+#define TEXTEDITOR_INSTANCE_H
+
+#include <SDL.h>
+
+#define INSTANCE_POLL_MS 100
+#define INSTANCE_TIMEOUT_MS 1000
+#define INSTANCE_MESSAGE_LENGTH 4200
+#define INSTANCE_SOCKET_NAME "texteditor.sock"
+
+typedef struct {
+    int fd;
+    char *socket_path;
+    SDL_Thread *thread;
+    SDL_atomic_t stop;
+    Uint32 event_type;
+    SDL_mutex *lock;
+    char *path;
+    int line;
+    int column;
+    int line_count;
+} Instance;
+
+int instanceRequest(const char *request, char *reply, int reply_size);
+
+int instanceHandOver(const char *path);
+
+int startInstance(Instance *instance);
+
+void stopInstance(Instance *instance);
+
+void instancePublish(Instance *instance, const char *path, int line, int column, int line_count);
+
+#endif
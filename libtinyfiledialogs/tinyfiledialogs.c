@@ -2900,26 +2900,35 @@ static int dirExists ( char const * const aDirPath )
 static int detectPresence ( char const * const aExecutable )
 {
 	char lBuff [MAX_PATH_OR_CMD] ;
-	char lTestedString [MAX_PATH_OR_CMD] = "which " ;
-	FILE * lIn ;
+	char const * lPath ;
+	char const * lEnd ;
+	struct stat lInfo ;
+	int lLength ;
+	int lPresent = 0 ;
 
-    strcat ( lTestedString , aExecutable ) ;
-	strcat( lTestedString, " 2>/dev/null ");
-    lIn = popen ( lTestedString , "r" ) ;
-    if ( ( fgets ( lBuff , sizeof ( lBuff ) , lIn ) != NULL )
-		&& ( ! strchr ( lBuff , ':' ) )
-		&& ( strncmp(lBuff, "no ", 3) ) )
-    {	/* present */
-    	pclose ( lIn ) ;
-	if (tinyfd_verbose) printf("detectPresence %s %d\n", aExecutable, 1);
-    	return 1 ;
-    }
-    else
-    {
-    	pclose ( lIn ) ;
-	if (tinyfd_verbose) printf("detectPresence %s %d\n", aExecutable, 0);
-    	return 0 ;
-    }
+	/* search PATH in process instead of forking "which" for every probe */
+	if ( strchr ( aExecutable , '/' ) )
+	{
+		lPresent = ! stat ( aExecutable , & lInfo ) && S_ISREG ( lInfo.st_mode )
+			&& ! access ( aExecutable , X_OK ) ;
+	}
+	else if ( ( lPath = getenv ( "PATH" ) ) )
+	{
+		while ( ! lPresent && * lPath )
+		{
+			lEnd = strchr ( lPath , ':' ) ;
+			lLength = lEnd ? (int) ( lEnd - lPath ) : (int) strlen ( lPath ) ;
+			if ( snprintf ( lBuff , sizeof ( lBuff ) , "%.*s/%s" ,
+					lLength ? lLength : 1 , lLength ? lPath : "." , aExecutable ) < (int) sizeof ( lBuff ) )
+			{
+				lPresent = ! stat ( lBuff , & lInfo ) && S_ISREG ( lInfo.st_mode )
+					&& ! access ( lBuff , X_OK ) ;
+			}
+			lPath = lEnd ? lEnd + 1 : lPath + lLength ;
+		}
+	}
+	if (tinyfd_verbose) printf("detectPresence %s %d\n", aExecutable, lPresent);
+	return lPresent ;
 }
 
 
@@ -3054,6 +3063,7 @@ static char const * terminalName ( )
         }
         else
         {
+            strcpy(lTerminalName , "" ) ;
             return NULL ;
         }
 
@@ -4210,7 +4220,7 @@ char const * tinyfd_inputBox(
 
 	if ( osascriptPresent ( ) )
 	{
-		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){strcpy(tinyfd_response,"applescript");return (char const *)1;}
+		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){osx9orBetter();strcpy(tinyfd_response,"applescript");return (char const *)1;}
 		strcpy ( lDialogString , "osascript ");
 		if ( ! osx9orBetter() ) strcat ( lDialogString , " -e 'tell application \"System Events\"' -e 'Activate'");
 		strcat ( lDialogString , " -e 'try' -e 'display dialog \"") ;
@@ -4687,7 +4697,7 @@ char const * tinyfd_saveFileDialog (
 
 	if ( osascriptPresent ( ) )
 	{
-		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){strcpy(tinyfd_response,"applescript");return (char const *)1;}
+		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){osx9orBetter();strcpy(tinyfd_response,"applescript");return (char const *)1;}
 		strcpy ( lDialogString , "osascript ");
 		if ( ! osx9orBetter() ) strcat ( lDialogString , " -e 'tell application \"Finder\"' -e 'Activate'");
 		strcat ( lDialogString , " -e 'try' -e 'POSIX path of ( choose file name " );
@@ -5011,7 +5021,7 @@ char const * tinyfd_openFileDialog (
 
 	if ( osascriptPresent ( ) )
 	{
-		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){strcpy(tinyfd_response,"applescript");return (char const *)1;}
+		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){osx9orBetter();strcpy(tinyfd_response,"applescript");return (char const *)1;}
 		strcpy ( lDialogString , "osascript ");
 		if ( ! osx9orBetter() ) strcat ( lDialogString , " -e 'tell application \"System Events\"' -e 'Activate'");
 		strcat ( lDialogString , " -e 'try' -e '" );
@@ -5381,7 +5391,7 @@ char const * tinyfd_selectFolderDialog (
 
 	if ( osascriptPresent ( ))
 	{
-		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){strcpy(tinyfd_response,"applescript");return (char const *)1;}
+		if (aTitle&&!strcmp(aTitle,"tinyfd_query")){osx9orBetter();strcpy(tinyfd_response,"applescript");return (char const *)1;}
 		strcpy ( lDialogString , "osascript ");
 		if ( ! osx9orBetter() ) strcat ( lDialogString , " -e 'tell application \"System Events\"' -e 'Activate'");
 		strcat ( lDialogString , " -e 'try' -e 'POSIX path of ( choose folder ");
@@ -0,0 +1,229 @@
+#include "linesort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const command_names[LINES_COMMAND_COUNT] = {
+        "sort", "sort-numeric", "unique", "reverse", "shuffle"
+};
+
+const char *lineCommandName(int command) {
+    return command_names[command];
+}
+
+static Uint64 textKey(const char *line) {
+    Uint64 key = 0;
+    SDL_bool ended = SDL_FALSE;
+    for (int i = 0; i < 8; i++) {
+        unsigned char c = ended ? 0 : (unsigned char) line[i];
+        ended = c == '\0';
+        key = key << 8 | c;
+    }
+    return key;
+}
+
+static Uint64 numericKey(const char *line) {
+    char *end;
+    double value = strtod(line, &end);
+    if (end == line || value != value) {
+        return 0;
+    }
+    Uint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits >> 63 ? ~bits : bits | 0x8000000000000000ULL;
+}
+
+static SDL_bool viewBefore(const LineView *a, const LineView *b, SDL_bool numeric) {
+    if (a->key != b->key) {
+        return a->key < b->key;
+    }
+    return !numeric && (a->key & 0xFF) != 0 && strcmp(a->line + 8, b->line + 8) < 0;
+}
+
+static SDL_bool sameText(const LineView *a, const LineView *b) {
+    return a->key == b->key && ((a->key & 0xFF) == 0 || strcmp(a->line + 8, b->line + 8) == 0);
+}
+
+static void insertionSort(LineView *views, int count, SDL_bool numeric) {
+    for (int i = 1; i < count; i++) {
+        LineView view = views[i];
+        int j = i;
+        for (; j > 0 && viewBefore(&view, &views[j - 1], numeric); j--) {
+            views[j] = views[j - 1];
+        }
+        views[j] = view;
+    }
+}
+
+static void mergeRuns(LineView *views, LineView *scratch, int middle, int count, SDL_bool numeric) {
+    if (middle == 0 || middle == count || !viewBefore(&views[middle], &views[middle - 1], numeric)) {
+        return;
+    }
+    memcpy(scratch, views, middle * sizeof(LineView));
+    int left = 0;
+    int right = middle;
+    int out = 0;
+    while (left < middle && right < count) {
+        views[out++] = viewBefore(&views[right], &scratch[left], numeric) ? views[right++] : scratch[left++];
+    }
+    memcpy(views + out, scratch + left, (middle - left) * sizeof(LineView));
+}
+
+static void mergeSort(LineView *views, LineView *scratch, int count, SDL_bool numeric) {
+    if (count <= LINESORT_INSERTION_RUN) {
+        insertionSort(views, count, numeric);
+        return;
+    }
+    int middle = count / 2;
+    mergeSort(views, scratch, middle, numeric);
+    mergeSort(views + middle, scratch + middle, count - middle, numeric);
+    mergeRuns(views, scratch, middle, count, numeric);
+}
+
+static int sortWorker(void *data) {
+    SortTask *task = data;
+    if (task->lines) {
+        for (int i = task->start; i < task->end; i++) {
+            char *line = task->lines[i];
+            task->views[i] = (LineView) {task->numeric ? numericKey(line) : textKey(line), line, i};
+        }
+        mergeSort(task->views + task->start, task->scratch + task->start, task->end - task->start, task->numeric);
+    } else {
+        mergeRuns(task->views + task->start, task->scratch + task->start, task->middle - task->start,
+                  task->end - task->start, task->numeric);
+    }
+    return 0;
+}
+
+static void runTasks(SortTask *tasks, int count) {
+    for (int i = 1; i < count; i++) {
+        tasks[i].thread = SDL_CreateThread(sortWorker, "sort", &tasks[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || tasks[i].thread == nullptr) {
+            sortWorker(&tasks[i]);
+        }
+    }
+    for (int i = 1; i < count; i++) {
+        if (tasks[i].thread) {
+            SDL_WaitThread(tasks[i].thread, nullptr);
+            tasks[i].thread = nullptr;
+        }
+    }
+}
+
+static int sortViews(LineView *views, char **lines, int count, SDL_bool numeric, int thread_count) {
+    LineView *scratch = malloc((count > 0 ? count : 1) * sizeof(LineView));
+    if (scratch == nullptr) {
+        return -1;
+    }
+    int runs = count / LINESORT_MIN_RUN;
+    if (runs > thread_count) {
+        runs = thread_count;
+    }
+    if (runs > LINESORT_MAX_THREADS) {
+        runs = LINESORT_MAX_THREADS;
+    }
+    if (runs < 1) {
+        runs = 1;
+    }
+
+    SortTask tasks[LINESORT_MAX_THREADS] = {0};
+    int bounds[LINESORT_MAX_THREADS + 1];
+    for (int i = 0; i <= runs; i++) {
+        bounds[i] = (int) ((long long) count * i / runs);
+    }
+    for (int i = 0; i < runs; i++) {
+        tasks[i] = (SortTask) {views, scratch, lines, bounds[i], bounds[i], bounds[i + 1], numeric, nullptr};
+    }
+    runTasks(tasks, runs);
+
+    for (int width = 1; width < runs; width *= 2) {
+        int merges = 0;
+        for (int i = 0; i + width < runs; i += 2 * width) {
+            int end = bounds[i + 2 * width < runs ? i + 2 * width : runs];
+            tasks[merges++] = (SortTask) {views, scratch, nullptr, bounds[i], bounds[i + width], end, numeric,
+                                          nullptr};
+        }
+        runTasks(tasks, merges);
+    }
+    free(scratch);
+    return 0;
+}
+
+static int sortLines(char **lines, int count, int command, int thread_count, int *kept, SDL_bool *changed) {
+    LineView *views = malloc((count > 0 ? count : 1) * sizeof(LineView));
+    if (views == nullptr || sortViews(views, lines, count, command == LINES_SORT_NUMERIC, thread_count) != 0) {
+        free(views);
+        return -1;
+    }
+
+    if (command == LINES_UNIQUE) {
+        Uint8 *drop = calloc(count > 0 ? count : 1, 1);
+        if (drop == nullptr) {
+            free(views);
+            return -1;
+        }
+        for (int i = 1; i < count; i++) {
+            drop[views[i].index] = sameText(&views[i], &views[i - 1]);
+        }
+        *kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (drop[i]) {
+                freeLine(lines[i]);
+            } else {
+                lines[(*kept)++] = lines[i];
+            }
+        }
+        *changed = *kept < count;
+        free(drop);
+    } else {
+        for (int i = 0; i < count; i++) {
+            *changed = *changed || lines[i] != views[i].line;
+            lines[i] = views[i].line;
+        }
+    }
+    free(views);
+    return 0;
+}
+
+int runLineCommand(Document *doc, int command, int first, int count, int thread_count) {
+    if (first < 0 || count < 0 || first + count > doc->line_count) {
+        return -1;
+    }
+    char **lines = doc->lines + first;
+    int kept = count;
+    SDL_bool changed = SDL_FALSE;
+
+    if (command == LINES_REVERSE || command == LINES_SHUFFLE) {
+        Uint64 state = SDL_GetPerformanceCounter() | 1;
+        for (int i = count - 1; i > 0; i--) {
+            int j = count - 1 - i;
+            if (command == LINES_SHUFFLE) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                j = (int) (state % (Uint64) (i + 1));
+            } else if (j >= i) {
+                break;
+            }
+            char *line = lines[i];
+            lines[i] = lines[j];
+            lines[j] = line;
+            changed = changed || i != j;
+        }
+    } else if (sortLines(lines, count, command, thread_count, &kept, &changed) != 0) {
+        return -1;
+    }
+
+    if (kept < count) {
+        memmove(&doc->lines[first + kept], &doc->lines[first + count],
+                (doc->line_count - first - count) * sizeof(char *));
+        doc->line_count -= count - kept;
+    }
+    if (changed) {
+        foldReplace(&doc->folds, first, count, kept);
+        doc->modified = 1;
+    }
+    return 0;
+}
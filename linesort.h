@@ -0,0 +1,41 @@
+#ifndef TEXTEDITOR_LINESORT_H
+#define TEXTEDITOR_LINESORT_H
+
+#include <SDL.h>
+#include "document.h"
+
+#define LINESORT_MAX_THREADS 64
+#define LINESORT_MIN_RUN 32768
+#define LINESORT_INSERTION_RUN 16
+
+enum {
+    LINES_SORT,
+    LINES_SORT_NUMERIC,
+    LINES_UNIQUE,
+    LINES_REVERSE,
+    LINES_SHUFFLE,
+    LINES_COMMAND_COUNT
+};
+
+typedef struct {
+    Uint64 key;
+    char *line;
+    int index;
+} LineView;
+
+typedef struct {
+    LineView *views;
+    LineView *scratch;
+    char **lines;
+    int start;
+    int middle;
+    int end;
+    SDL_bool numeric;
+    SDL_Thread *thread;
+} SortTask;
+
+const char *lineCommandName(int command);
+
+int runLineCommand(Document *doc, int command, int first, int count, int thread_count);
+
+#endif
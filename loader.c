@@ -0,0 +1,325 @@
+#include "loader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utf8.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#define FIRST_CHUNK_LINES 256
+#define LOAD_CHUNK_LINES 16384
+#define STREAM_BUFFER_SIZE (1 << 16)
+#define STREAM_POLL_MS 100
+
+static LoadChunk *newChunk(int capacity) {
+    LoadChunk *chunk = malloc(sizeof(LoadChunk) + capacity * sizeof(char *));
+    if (chunk) {
+        chunk->next = nullptr;
+        chunk->count = 0;
+    }
+    return chunk;
+}
+
+static void freeChunks(LoadChunk *chunk) {
+    while (chunk) {
+        LoadChunk *next = chunk->next;
+        for (int i = 0; i < chunk->count; i++) {
+            freeLine(chunk->lines[i]);
+        }
+        free(chunk);
+        chunk = next;
+    }
+}
+
+static void trimChunk(LoadChunk *chunk, int available) {
+    for (int i = chunk ? chunk->count : 0; i < available; i++) {
+        freeLine(chunk->lines[i]);
+    }
+}
+
+static void notifyLoader(Loader *loader) {
+    if (SDL_AtomicCAS(&loader->notified, 0, 1)) {
+        SDL_Event event = {0};
+        event.type = loader->event_type;
+        SDL_PushEvent(&event);
+    }
+}
+
+static void publishChunk(Loader *loader, LoadChunk *chunk, SDL_bool finished, SDL_bool failed) {
+    SDL_LockMutex(loader->lock);
+    if (chunk && chunk->count > 0) {
+        if (loader->tail) {
+            loader->tail->next = chunk;
+        } else {
+            loader->head = chunk;
+        }
+        loader->tail = chunk;
+    } else {
+        free(chunk);
+    }
+    loader->finished = finished;
+    loader->failed = failed;
+    SDL_UnlockMutex(loader->lock);
+    notifyLoader(loader);
+}
+
+static int loadWorker(void *data) {
+    Loader *loader = data;
+    FILE *file = fopen(loader->path, "rb");
+    Stream stream;
+    TextReader reader;
+    if (file == nullptr || openReadStream(&stream, file) != 0 || openTextReader(&reader, &stream) != 0) {
+        if (file) {
+            closeStream(&stream);
+            fclose(file);
+        }
+        publishChunk(loader, nullptr, SDL_TRUE, SDL_TRUE);
+        return 1;
+    }
+
+    int capacity = FIRST_CHUNK_LINES;
+    LoadChunk *chunk = newChunk(capacity);
+    int available = chunk ? allocLines(chunk->lines, capacity) : 0;
+    SDL_bool failed = available == 0;
+
+    while (!failed && !SDL_AtomicGet(&loader->cancel)) {
+        char *line = chunk->lines[chunk->count];
+        if (!readTextLine(&reader, line, MAX_LINE_LENGTH)) {
+            break;
+        }
+        chunk->count++;
+
+        if (chunk->count == available) {
+            publishChunk(loader, chunk, SDL_FALSE, SDL_FALSE);
+            capacity = LOAD_CHUNK_LINES;
+            chunk = newChunk(capacity);
+            available = chunk ? allocLines(chunk->lines, capacity) : 0;
+            failed = available == 0;
+        }
+    }
+
+    trimChunk(chunk, available);
+    closeTextReader(&reader);
+    SDL_bool damaged = closeStream(&stream) != 0;
+    fclose(file);
+    SDL_LockMutex(loader->lock);
+    loader->format = reader.format;
+    loader->damaged = damaged;
+    SDL_UnlockMutex(loader->lock);
+    publishChunk(loader, chunk, SDL_TRUE, failed);
+    return 0;
+}
+
+#ifndef _WIN32
+static int streamWorker(void *data) {
+    Loader *loader = data;
+    char *buffer = malloc(STREAM_BUFFER_SIZE);
+    LoadChunk *chunk = newChunk(FIRST_CHUNK_LINES);
+    int available = chunk ? allocLines(chunk->lines, FIRST_CHUNK_LINES) : 0;
+    SDL_bool failed = buffer == nullptr || available == 0;
+    SDL_bool eof = SDL_FALSE;
+    size_t length = 0;
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+
+    while (!failed && !eof && !SDL_AtomicGet(&loader->cancel)) {
+        int ready = poll(&input, 1, STREAM_POLL_MS);
+        ssize_t got = ready > 0 ? read(STDIN_FILENO, buffer + length, STREAM_BUFFER_SIZE - length) : 0;
+        if (ready < 0 || got < 0) {
+            failed = errno != EINTR && errno != EAGAIN;
+            continue;
+        }
+        if (ready == 0) {
+            continue;
+        }
+        eof = got == 0;
+        length += got;
+
+        size_t pos = 0;
+        while (!failed) {
+            size_t limit = utf8Cut(buffer + pos, length - pos, MAX_LINE_LENGTH - 1);
+            const char *newline = memchr(buffer + pos, '\n', limit);
+            size_t segment = newline ? (size_t) (newline - buffer) - pos : limit;
+            if (newline == nullptr && length - pos < MAX_LINE_LENGTH && !(eof && limit > 0)) {
+                break;
+            }
+            memcpy(chunk->lines[chunk->count], buffer + pos, segment);
+            chunk->lines[chunk->count][segment] = '\0';
+            chunk->count++;
+            pos += newline ? segment + 1 : segment;
+
+            if (chunk->count == available) {
+                publishChunk(loader, chunk, SDL_FALSE, SDL_FALSE);
+                chunk = newChunk(LOAD_CHUNK_LINES);
+                available = chunk ? allocLines(chunk->lines, LOAD_CHUNK_LINES) : 0;
+                failed = available == 0;
+            }
+        }
+        memmove(buffer, buffer + pos, length - pos);
+        length -= pos;
+
+        if (!failed && chunk->count > 0) {
+            trimChunk(chunk, available);
+            publishChunk(loader, chunk, SDL_FALSE, SDL_FALSE);
+            chunk = newChunk(FIRST_CHUNK_LINES);
+            available = chunk ? allocLines(chunk->lines, FIRST_CHUNK_LINES) : 0;
+            failed = available == 0;
+        }
+    }
+
+    trimChunk(chunk, available);
+    free(buffer);
+    publishChunk(loader, chunk, SDL_TRUE, failed);
+    return 0;
+}
+#endif
+
+int initLoader(Loader *loader) {
+    memset(loader, 0, sizeof(*loader));
+    loader->event_type = SDL_RegisterEvents(1);
+    loader->lock = SDL_CreateMutex();
+    if (loader->event_type == (Uint32) -1 || loader->lock == nullptr) {
+        printf("Loader Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
+
+static void joinLoader(Loader *loader) {
+    if (loader->thread) {
+        SDL_WaitThread(loader->thread, nullptr);
+        loader->thread = nullptr;
+    }
+}
+
+void destroyLoader(Loader *loader) {
+    cancelLoad(loader);
+    joinLoader(loader);
+    freeChunks(loader->head);
+    free(loader->path);
+    if (loader->lock) {
+        SDL_DestroyMutex(loader->lock);
+    }
+    memset(loader, 0, sizeof(*loader));
+}
+
+int startLoad(Loader *loader, const char *path) {
+    free(loader->path);
+    loader->path = strdup(path);
+    if (loader->path == nullptr) {
+        return 1;
+    }
+
+    SDL_AtomicSet(&loader->cancel, 0);
+    SDL_AtomicSet(&loader->notified, 0);
+    loader->finished = SDL_FALSE;
+    loader->failed = SDL_FALSE;
+    loader->damaged = SDL_FALSE;
+    loader->stream = strcmp(path, "-") == 0;
+    loader->lines_loaded = 0;
+    loader->start = SDL_GetPerformanceCounter();
+    defaultTextFormat(&loader->format);
+
+#ifdef _WIN32
+    if (loader->stream) {
+        printf("Error: Reading from stdin is not supported on Windows.\n");
+        free(loader->path);
+        loader->path = nullptr;
+        return 1;
+    }
+    loader->thread = SDL_CreateThread(loadWorker, "loader", loader);
+#else
+    loader->thread = SDL_CreateThread(loader->stream ? streamWorker : loadWorker, "loader", loader);
+#endif
+    if (loader->thread == nullptr) {
+        printf("SDL_CreateThread Error: %s\n", SDL_GetError());
+        free(loader->path);
+        loader->path = nullptr;
+        return 1;
+    }
+    loader->active = SDL_TRUE;
+    return 0;
+}
+
+void cancelLoad(Loader *loader) {
+    if (loader->active) {
+        SDL_AtomicSet(&loader->cancel, 1);
+    }
+}
+
+void stopLoad(Loader *loader, Document *doc) {
+    if (!loader->active) {
+        return;
+    }
+    cancelLoad(loader);
+    joinLoader(loader);
+    drainLoader(loader, doc);
+}
+
+SDL_bool drainLoader(Loader *loader, Document *doc) {
+    if (!loader->active) {
+        return SDL_FALSE;
+    }
+
+    SDL_AtomicSet(&loader->notified, 0);
+    SDL_LockMutex(loader->lock);
+    LoadChunk *chunk = loader->head;
+    SDL_bool finished = loader->finished;
+    SDL_bool failed = loader->failed;
+    loader->head = nullptr;
+    loader->tail = nullptr;
+    SDL_UnlockMutex(loader->lock);
+
+    while (chunk) {
+        LoadChunk *next = chunk->next;
+        int first = 0;
+        if (loader->lines_loaded == 0 && doc->line_count == 1 && doc->lines[0][0] == '\0') {
+            freeLine(doc->lines[0]);
+            doc->lines[0] = chunk->lines[0];
+            first = 1;
+        }
+        if (appendLines(doc, chunk->lines + first, chunk->count - first) != 0) {
+            chunk->next = nullptr;
+            memmove(chunk->lines, chunk->lines + first, (chunk->count - first) * sizeof(char *));
+            chunk->count -= first;
+            freeChunks(chunk);
+            freeChunks(next);
+            cancelLoad(loader);
+            failed = SDL_TRUE;
+            break;
+        }
+        loader->lines_loaded += chunk->count;
+        free(chunk);
+        chunk = next;
+    }
+
+    if (!finished) {
+        return SDL_FALSE;
+    }
+
+    joinLoader(loader);
+    doc->format = loader->format;
+    double elapsed = (SDL_GetPerformanceCounter() - loader->start) * 1000.0 / SDL_GetPerformanceFrequency();
+    SDL_bool completed = SDL_FALSE;
+    if (failed && loader->lines_loaded == 0) {
+        printf("Error: Could not open file for reading.\n");
+    } else if (failed) {
+        printf("Error: Ran out of memory after %ld lines of %s.\n", loader->lines_loaded, loader->path);
+    } else if (loader->damaged && !SDL_AtomicGet(&loader->cancel)) {
+        printf("Error: %s is damaged or cut short; kept the first %ld lines.\n", loader->path, loader->lines_loaded);
+    } else if (SDL_AtomicGet(&loader->cancel)) {
+        printf("Load of %s canceled after %ld lines.\n", loader->path, loader->lines_loaded);
+    } else {
+        printf("Loaded %ld lines from %s in %.1f ms (%s, %s%s%s%s).\n", loader->lines_loaded, loader->path, elapsed,
+               encodingName(doc->format.encoding), eolName(doc->format.eol),
+               doc->format.mixed_eol ? ", mixed line endings" : "",
+               doc->format.compression != COMPRESSION_NONE ? ", " : "",
+               doc->format.compression != COMPRESSION_NONE ? compressionName(doc->format.compression) : "");
+        completed = SDL_TRUE;
+    }
+    loader->active = SDL_FALSE;
+    return completed;
+}
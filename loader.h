@@ -0,0 +1,44 @@
+#ifndef TEXTEDITOR_LOADER_H
+#define TEXTEDITOR_LOADER_H
+
+#include <SDL.h>
+#include "document.h"
+
+typedef struct LoadChunk {
+    struct LoadChunk *next;
+    int count;
+    char *lines[];
+} LoadChunk;
+
+typedef struct {
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_atomic_t cancel;
+    SDL_atomic_t notified;
+    Uint32 event_type;
+    char *path;
+    LoadChunk *head;
+    LoadChunk *tail;
+    SDL_bool finished;
+    SDL_bool failed;
+    SDL_bool damaged;
+    SDL_bool active;
+    SDL_bool stream;
+    long lines_loaded;
+    Uint64 start;
+    TextFormat format;
+} Loader;
+
+int initLoader(Loader *loader);
+
+void destroyLoader(Loader *loader);
+
+int startLoad(Loader *loader, const char *path);
+
+void cancelLoad(Loader *loader);
+
+void stopLoad(Loader *loader, Document *doc);
+
+SDL_bool drainLoader(Loader *loader, Document *doc);
+
+#endif
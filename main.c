@@ -1,168 +1,387 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include "tinyfiledialogs.h"
+#include "replay.h"
+#include "document.h"
+#include "loader.h"
+#include "paged.h"
+#include "edit.h"
+#include "arena.h"
+#include "glyphs.h"
+#include "watch.h"
+#include "diff.h"
+#include "scroll.h"
+#include "font.h"
+#include "startup.h"
+#include "picker.h"
+#include "session.h"
+#include "batch.h"
+#include "instance.h"
+#include "utf8.h"
+#include "linesort.h"
+#include "columns.h"
+#include "hex.h"
+#include "snapshot.h"
 
-#define MAX_LINES 100
-#define MAX_LINE_LENGTH 115
 #define WINDOW_WIDTH 1710
 #define WINDOW_HEIGHT 900
 #define FONT_SIZE 24
-#define FONT_PATH "../IBMPlexMono-Regular.ttf"
 #define SCROLL_SPEED 20
+#define EDITOR_IDLE_MS 10
+#define RENDER_IDLE_MS 100
+
+typedef struct {
+    Document doc;
+    Loader loader;
+    FileWatch watch;
+    ChangeMarkers markers;
+    SmoothScroll scroll;
+    CompareView compare;
+    PagedFile paged;
+    HexView hex;
+    ColumnView columns;
+    FilePicker picker;
+    Session session;
+    Instance instance;
+    StartupTimer *startup;
+    InputQueue input;
+    SnapshotExchange exchange;
+    int cursor_pos;
+    int current_line;
+    int line_height;
+    int window_width;
+    int window_height;
+    Uint64 version;
+    Uint64 content;
+    Uint32 handled;
+    Uint32 raise_count;
+    SDL_bool done;
+} Editor;
+
+
+int init(SDL_Window **window, SDL_Renderer **renderer, TTF_Font **font, const char *font_path,
+         StartupTimer *startup);
 
+void cleanup(SDL_Window *window, SDL_Renderer *renderer, TTF_Font *font);
 
-int init(SDL_Window **window, SDL_Renderer **renderer, TTF_Font **font);
+int editorThread(void *data);
 
-void cleanup(SDL_Window *window, SDL_Renderer *renderer, TTF_Font *font);
+SDL_bool handleInput(Editor *editor, const InputEvent *input);
+
+void publishView(Editor *editor, SDL_bool changed);
+
+void renderText(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view, int x, int y,
+                Sint64 top_row, int window_height);
+
+void renderHexView(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view, int x,
+                   int y, Sint64 top_row, int window_height);
+
+int renderLine(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const char *text, long line_number,
+               int mark, int x, int y, int cursor_pos, int *cursor_x);
+
+int renderCells(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view,
+                const char *text, long line_number, int mark, int x, int y, int cursor_pos, int *cursor_x);
+
+void renderMark(SDL_Renderer *renderer, int mark, int y, int height);
+
+void renderCursor(SDL_Renderer *renderer, int cursor_x, int cursor_y);
 
-void renderText(SDL_Renderer *renderer, TTF_Font *font, char lines[MAX_LINES][MAX_LINE_LENGTH], int cursor_pos,
-                int current_line, int x, int y, int line_count, int *scroll_offset, int window_height);
+void renderPicker(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view);
 
-void handleTextInput(char lines[MAX_LINES][MAX_LINE_LENGTH], const char *input, int *cursor_pos, int current_line);
+void toggleFold(Document *doc, int current_line);
 
-void handleEnterKey(char lines[MAX_LINES][MAX_LINE_LENGTH], int *current_line, int *cursor_pos, int *line_count);
+void toggleAllFolds(Document *doc, int *current_line, int *cursor_pos);
 
-void handleBackspace(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line, int *line_count);
+void applyLineCommand(Document *doc, Loader *loader, ChangeMarkers *markers, ColumnView *columns, int command,
+                      int *current_line, int *cursor_pos);
 
-void moveCursorLeft(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line);
+void handlePagedTextInput(PagedFile *paged, const char *input, int *cursor_pos, int current_line);
 
-void moveCursorRight(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line);
+void handlePagedKey(PagedFile *paged, SDL_Keycode key, SDL_Keymod mod, int *cursor_pos, int *current_line);
 
-void moveCursorUp(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line);
+SDL_bool viewShortcut(SDL_Keycode key, SDL_Keymod mod);
 
-void moveCursorDown(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line, int line_count);
+SDL_bool handleScroll(SDL_Event event, SmoothScroll *scroll);
 
-void insertLine(char lines[MAX_LINES][MAX_LINE_LENGTH], int index, int line_count);
+void handleExternalChange(FileWatch *watch, Document *doc, ChangeMarkers *markers, ColumnView *columns, int *cursor_pos,
+                          int *current_line, SmoothScroll *scroll, int line_height, int window_height);
 
-void removeLine(char lines[MAX_LINES][MAX_LINE_LENGTH], int index, int *line_count);
+ScrollOffset bottomScrollOffset(Document *doc, int line_height, int window_height);
 
-void optLeft(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int current_line);
+ScrollOffset viewScrollLimit(Document *doc, PagedFile *paged, HexView *hex, CompareView *compare, int line_height,
+                             int window_height);
 
-void optRight(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int current_line);
+void toggleFollow(FileWatch *watch, Document *doc, SmoothScroll *scroll, int line_height, int window_height);
 
-void cmdRight(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int current_line);
+void SaveDialog(Document *doc, PagedFile *paged, FileWatch *watch, ChangeMarkers *markers);
 
-void cmdLeft(int *cursor_pos);
+void OpenDialog(Document *doc, Loader *loader, PagedFile *paged, HexView *hex, FileWatch *watch,
+                ChangeMarkers *markers, ColumnView *columns, int *current_line, int *cursor_pos);
 
-void handleScroll(SDL_Event event, int *scroll_offset);
+void openDocument(const char *path, Document *doc, Loader *loader, PagedFile *paged, HexView *hex, FileWatch *watch,
+                  ChangeMarkers *markers, ColumnView *columns, int *current_line, int *cursor_pos);
 
-void SaveDialog(char lines[MAX_LINES][MAX_LINE_LENGTH]);
+void toggleCompareView(CompareView *compare, Document *doc, FileWatch *watch, SmoothScroll *scroll);
 
-void OpenDialog(char lines[MAX_LINES][MAX_LINE_LENGTH], int *line_count, int *current_line, int *cursor_pos);
+void restoreSession(Session *session, Document *doc, PagedFile *paged, SmoothScroll *scroll, int *cursor_pos,
+                    int *current_line, int line_height, int window_height);
 
 
-int main() {
+
+
+int main(int argc, char *argv[]) {
     SDL_Window *window = nullptr;
     SDL_Renderer *renderer = nullptr;
     TTF_Font *font = nullptr;
+    const char *record_path = nullptr;
+    const char *replay_path = nullptr;
+    const char *font_path = nullptr;
+    const char *open_path = nullptr;
+    SDL_bool single = SDL_FALSE;
+    StartupTimer startup;
+
+    startupBegin(&startup, SDL_FALSE);
+    installAllocationCounter();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) {
+            font_path = argv[++i];
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            return runBatch(argv[i + 1], argv + i + 2, argc - i - 2);
+        } else if (strcmp(argv[i], "--single") == 0) {
+            single = SDL_TRUE;
+        } else if (strcmp(argv[i], "--query") == 0) {
+            char reply[INSTANCE_MESSAGE_LENGTH];
+            if (instanceRequest("query\n", reply, sizeof(reply)) != 0) {
+                printf("No running instance to query.\n");
+                return 1;
+            }
+            fputs(reply, stdout);
+            return 0;
+        } else if (strcmp(argv[i], "--startup-times") == 0) {
+            startup.enabled = SDL_TRUE;
+        } else if ((argv[i][0] != '-' || strcmp(argv[i], "-") == 0) && open_path == nullptr) {
+            open_path = argv[i];
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            printf("Only one file can be open; ignoring %s.\n", argv[i]);
+        } else {
+            printf("Usage: %s [--record file | --replay file] [--font file.ttf] [--startup-times] [--single]"
+                   " [file | -]\n       %s --batch script file...\n       %s --query\n", argv[0], argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (single && instanceHandOver(open_path) == 0) {
+        return 0;
+    }
 
-    if (init(&window, &renderer, &font) != 0) {
+    Recorder recorder = {0};
+    Replayer replayer = {0};
+    int replay_width = WINDOW_WIDTH;
+    int replay_height = WINDOW_HEIGHT;
+    if (replay_path) {
+        if (replayerOpen(&replayer, replay_path, &replay_width, &replay_height) != 0) {
+            return 1;
+        }
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, REPLAY_VIDEO_DRIVER);
+    }
+
+    if (init(&window, &renderer, &font, font_path, &startup) != 0) {
         return 1;
     }
 
-    char lines[MAX_LINES][MAX_LINE_LENGTH] = {{0}};
-    int cursor_pos = 0;
-    int current_line = 0;
-    int line_count = 1;
-    int scroll_offset = 0;
+    Editor editor = {0};
+    Overscan overscan = {0};
+    GlyphCache glyphs;
+    FrameArena arena;
+    FrameStats frame_stats = {0};
+    if (initDocument(&editor.doc) != 0 || initLoader(&editor.loader) != 0 || initWatch(&editor.watch) != 0 ||
+        initMarkers(&editor.markers) != 0 || initScroll(&editor.scroll, replay_path != nullptr) != 0 ||
+        initInputQueue(&editor.input) != 0 || initExchange(&editor.exchange) != 0 ||
+        initGlyphCache(&glyphs, renderer, font) != 0 ||
+        arenaInit(&arena, FRAME_ARENA_SIZE) != 0) {
+        printf("Error: Could not allocate the document.\n");
+        cleanup(window, renderer, font);
+        return 1;
+    }
+    initPicker(&editor.picker);
+    initColumns(&editor.columns);
+    startupMark(&startup, "editor state");
+    editor.startup = &startup;
+    editor.line_height = glyphs.cell_height;
+    editor.scroll.row_height = glyphs.cell_height;
     SDL_SetWindowMinimumSize(window, WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (replay_path) {
+        SDL_SetWindowSize(window, replay_width, replay_height);
+    } else if (record_path && recorderOpen(&recorder, record_path, WINDOW_WIDTH, WINDOW_HEIGHT) != 0) {
+        cleanup(window, renderer, font);
+        return 1;
+    }
+
+    Session *session = &editor.session;
+    if (!replay_path && openSession(session) == 0) {
+        if (open_path == nullptr && sessionRestores(session, session->data->path)) {
+            open_path = session->data->path;
+        }
+        session->pending = open_path && sessionRestores(session, open_path);
+        startupMark(&startup, "session");
+    }
+    if (open_path) {
+        openDocument(open_path, &editor.doc, &editor.loader, &editor.paged, &editor.hex, &editor.watch,
+                     &editor.markers, &editor.columns, &editor.current_line, &editor.cursor_pos);
+        if (session->pending && editor.paged.data) {
+            restoreSession(session, &editor.doc, &editor.paged, &editor.scroll, &editor.cursor_pos,
+                           &editor.current_line, glyphs.cell_height, WINDOW_HEIGHT);
+        }
+    }
+
+    if (single) {
+        startInstance(&editor.instance);
+    }
+
+    SDL_GetWindowSize(window, &editor.window_width, &editor.window_height);
+    SDL_Thread *editor_thread = SDL_CreateThread(editorThread, "editor", &editor);
+    if (editor_thread == nullptr) {
+        printf("Error: Could not start the editor thread: %s\n", SDL_GetError());
+        cleanup(window, renderer, font);
+        return 1;
+    }
 
+    ViewSnapshot *view = nullptr;
+    Uint64 shown_version = 0;
+    Uint64 shown_content = 0;
+    Sint64 shown_row = -1;
+    double shown_position = -1;
+    Uint32 raised = 0;
+    Uint32 posted = 0;
     SDL_bool done = SDL_FALSE;
     SDL_StartTextInput();
 
     while (!done) {
         SDL_Event event;
-        int window_width, window_height;
-        SDL_GetWindowSize(window, &window_width, &window_height);
-        if (SDL_PollEvent(&event)) {
+        if (replay_path && (view ? view->events : 0) == posted) {
+            replayPump(&replayer, window);
+        }
+        SDL_bool warming = startup.done && glyphs.warm_next <= GLYPH_WARM_LAST;
+        for (int got = SDL_WaitEventTimeout(&event, warming ? 0 : RENDER_IDLE_MS); got; got = SDL_PollEvent(&event)) {
+            if (event.type == editor.exchange.event_type) {
+                continue;
+            }
+            int window_width, window_height;
+            SDL_GetWindowSize(window, &window_width, &window_height);
             SDL_Keymod mod = SDL_GetModState();
-            switch (event.type) {
-                case SDL_QUIT:
-                    done = SDL_TRUE;
-                    break;
-
-                case SDL_TEXTINPUT:
-                    handleTextInput(lines, event.text.text, &cursor_pos, current_line);
-                    break;
+            recordEvent(&recorder, &event, mod, window_width, window_height);
+            if (postInput(&editor.input, &(InputEvent) {event, mod, window_width, window_height}) == 0) {
+                posted++;
+            }
+            done = done || event.type == SDL_QUIT;
+        }
 
-                case SDL_KEYDOWN:
-                    switch (event.key.keysym.sym) {
-                        case SDLK_LEFT:
-                            if (mod & KMOD_ALT) {
-                                optLeft(lines, &cursor_pos, current_line);
-                            } else if (mod & KMOD_GUI) {
-                                cmdLeft(&cursor_pos);
-                            } else {
-                                moveCursorLeft(lines, &cursor_pos, &current_line);
-                            }
-                            break;
-
-                        case SDLK_RIGHT:
-                            if (mod & KMOD_ALT) {
-                                optRight(lines, &cursor_pos, current_line);
-                            } else if (mod & KMOD_GUI) {
-                                cmdRight(lines, &cursor_pos, current_line);
-                            } else {
-                                moveCursorRight(lines, &cursor_pos, &current_line);
-                            }
-                            break;
-
-                        case SDLK_BACKSPACE:
-                            handleBackspace(lines, &cursor_pos, &current_line, &line_count);
-                            break;
-
-                        case SDLK_RETURN:
-                            handleEnterKey(lines, &current_line, &cursor_pos, &line_count);
-                            break;
-
-                        case SDLK_UP:
-                            moveCursorUp(lines, &cursor_pos, &current_line);
-                            break;
-                        case SDLK_DOWN:
-                            moveCursorDown(lines, &cursor_pos, &current_line, line_count);
-                            break;
-
-                        case SDLK_s:
-                            if (mod & KMOD_CTRL) {
-                                SaveDialog(lines);
-                            }
-                            break;
-
-                        case SDLK_o:
-                            if (mod & KMOD_CTRL) {
-                                OpenDialog(lines, &line_count, &current_line, &cursor_pos);
-                            }
-                            break;
-                    }
-                    break;
-                case SDL_MOUSEWHEEL:
-                    handleScroll(event, &scroll_offset);
-                    break;
+        view = takeSnapshot(&editor.exchange, view);
+        if (view == nullptr || view->version == shown_version) {
+            if (warming) {
+                warmGlyphCache(&glyphs, GLYPH_WARM_STEP);
             }
+            continue;
+        }
+        shown_version = view->version;
+        if (view->raise_count != raised) {
+            raised = view->raise_count;
+            SDL_RaiseWindow(window);
+        }
+        if (view->content == shown_content && view->row == shown_row && view->position == shown_position) {
+            continue;
+        }
+        if (view->content != shown_content) {
+            invalidateOverscan(&overscan);
+        }
+        shown_content = view->content;
+        shown_row = view->row;
+        shown_position = view->position;
+
+        beginFrame(&arena, &frame_stats);
+        if (view->kind == VIEW_PICKER) {
             SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
             SDL_RenderClear(renderer);
-            renderText(renderer, font, lines, cursor_pos, current_line, 50, 50, line_count, &scroll_offset, window_height);
-            SDL_RenderPresent(renderer);
+            renderPicker(renderer, &glyphs, &arena, view);
+        } else {
+            if (!overscanCovers(&overscan, view->row, view->position, view->window_width, view->window_height)) {
+                SDL_bool cached = beginOverscan(&overscan, renderer, view->row, glyphs.cell_height,
+                                                view->window_width, view->window_height) == 0;
+                Sint64 top_row = cached ? overscan.row : view->row;
+                int text_y = cached ? SNAPSHOT_TEXT_Y : SNAPSHOT_TEXT_Y - (int) view->position;
+                int view_height = cached ? overscan.height : view->window_height;
+                if (view->kind == VIEW_HEX) {
+                    renderHexView(renderer, &glyphs, &arena, view, 5, text_y, top_row, view_height);
+                } else {
+                    renderText(renderer, &glyphs, &arena, view, 50, text_y, top_row, view_height);
+                }
+                if (cached) {
+                    endOverscan(&overscan, renderer);
+                }
+            }
+            if (overscan.valid) {
+                presentOverscan(&overscan, renderer, view->row, view->position);
+            }
         }
-
+        SDL_RenderPresent(renderer);
+        startupFinish(&startup);
+        endFrame(&frame_stats);
+        if (replay_path) {
+            replayFrameDone(&replayer);
+        }
+    }
+    SDL_WaitThread(editor_thread, nullptr);
+    waitDialogProbe(&startup);
+    stopInstance(&editor.instance);
+    sessionSaveFolds(session, editor.paged.data || editor.doc.modified ? nullptr : &editor.doc.folds);
+    closeSession(session);
+    recorderClose(&recorder);
+    if (replay_path) {
+        replayerClose(&replayer);
+        printFrameStats(&arena, &frame_stats);
     }
+    freeSnapshot(view);
+    destroyExchange(&editor.exchange);
+    destroyInputQueue(&editor.input);
+    destroyLoader(&editor.loader);
+    destroyWatch(&editor.watch);
+    freeMarkers(&editor.markers);
+    destroyScroll(&editor.scroll);
+    freeOverscan(&overscan);
+    closeCompareView(&editor.compare);
+    freePicker(&editor.picker);
+    pagedClose(&editor.paged);
+    hexClose(&editor.hex);
+    freeDocument(&editor.doc);
+    freeColumns(&editor.columns);
+    freeGlyphCache(&glyphs);
+    arenaFree(&arena);
     cleanup(window, renderer, font);
     return 0;
 }
 
-int init(SDL_Window **window, SDL_Renderer **renderer, TTF_Font **font) {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+int init(SDL_Window **window, SDL_Renderer **renderer, TTF_Font **font, const char *font_path,
+         StartupTimer *startup) {
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
         printf("SDL_Init Error: %s\n", SDL_GetError());
         return 1;
     }
+    startupMark(startup, "SDL_Init");
 
     if (TTF_Init() == -1) {
         printf("TTF_Init Error: %s\n", TTF_GetError());
         SDL_Quit();
         return 1;
     }
+    startupMark(startup, "TTF_Init");
 
     *window = SDL_CreateWindow("SDL2 Text Input", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
                                WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
@@ -171,16 +390,26 @@ int init(SDL_Window **window, SDL_Renderer **renderer, TTF_Font **font) {
         SDL_Quit();
         return 1;
     }
+    startupMark(startup, "window");
 
-    *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_ACCELERATED);
+    *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC |
+                                                  SDL_RENDERER_TARGETTEXTURE);
+    if (!*renderer) {
+        *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_SOFTWARE);
+    }
     if (!*renderer) {
         printf("SDL_CreateRenderer Error: %s\n", SDL_GetError());
         SDL_DestroyWindow(*window);
         SDL_Quit();
         return 1;
     }
+    startupMark(startup, "renderer");
 
-    *font = TTF_OpenFont(FONT_PATH, FONT_SIZE);
+    if (font_path) {
+        *font = TTF_OpenFont(font_path, FONT_SIZE);
+    } else {
+        *font = TTF_OpenFontRW(SDL_RWFromConstMem(font_data, (int) font_data_size), 1, FONT_SIZE);
+    }
     if (!*font) {
         printf("TTF_OpenFont Error: %s\n", TTF_GetError());
         SDL_DestroyRenderer(*renderer);
@@ -189,6 +418,7 @@ int init(SDL_Window **window, SDL_Renderer **renderer, TTF_Font **font) {
         SDL_Quit();
         return 1;
     }
+    startupMark(startup, "font");
 
     return 0;
 }
@@ -202,304 +432,902 @@ void cleanup(SDL_Window *window, SDL_Renderer *renderer, TTF_Font *font) {
     SDL_Quit();
 }
 
-void renderText(SDL_Renderer *renderer, TTF_Font *font, char lines[MAX_LINES][MAX_LINE_LENGTH], int cursor_pos,
-                int current_line, int x, int y, int line_count, int *scroll_offset, int window_height) {
-    SDL_Color white = {255, 255, 255, 255};
-    y = y - *scroll_offset;
-    int cursor_x = x;
-    int cursor_y = y;
+int editorThread(void *data) {
+    Editor *editor = data;
+    SDL_bool changed = SDL_FALSE;
+    SDL_bool indexing = SDL_FALSE;
+    publishView(editor, SDL_TRUE);
+
+    while (!editor->done) {
+        InputEvent input;
+        if (!takeInput(&editor->input, &input, indexing ? 0 : EDITOR_IDLE_MS)) {
+            SDL_bool refresh = SDL_FALSE;
+            if (editor->paged.data) {
+                long indexed = pagedLineCount(&editor->paged);
+                indexing = pagedIndexStep(&editor->paged, PAGED_INDEX_STEP);
+                refresh = pagedLineCount(&editor->paged) > indexed;
+            } else if (!editor->loader.active) {
+                pollWatch(&editor->watch);
+                refresh = updateMarkers(&editor->markers, &editor->doc);
+            }
+            if (refresh) {
+                publishView(editor, SDL_TRUE);
+            }
+            continue;
+        }
+        changed = handleInput(editor, &input) || changed;
+        editor->handled++;
+        if (!editor->done && !inputPending(&editor->input)) {
+            publishView(editor, changed);
+            changed = SDL_FALSE;
+        }
+    }
+    return 0;
+}
 
-    for (int i = 0; i < line_count && i < MAX_LINES; i++) {
-        char line_number[10];
-        snprintf(line_number, sizeof(line_number), "%d", i + 1);
+SDL_bool handleInput(Editor *editor, const InputEvent *input) {
+    const SDL_Event *event = &input->event;
+    SDL_Keymod mod = input->mod;
+    editor->window_width = input->window_width;
+    editor->window_height = input->window_height;
+
+    switch (event->type) {
+        case SDL_QUIT:
+            editor->done = SDL_TRUE;
+            break;
+
+        case SDL_TEXTINPUT:
+            if (editor->picker.active) {
+                pickerType(&editor->picker, event->text.text);
+                break;
+            }
+            if (editor->compare.active) {
+                break;
+            }
+            if (editor->hex.path) {
+                hexTextInput(&editor->hex, event->text.text);
+            } else if (editor->paged.data) {
+                handlePagedTextInput(&editor->paged, event->text.text, &editor->cursor_pos,
+                                     editor->current_line);
+            } else {
+                handleTextInput(&editor->doc, event->text.text, &editor->cursor_pos, editor->current_line);
+                columnsEdited(&editor->columns, editor->current_line, 1, 1);
+                markEdited(&editor->markers);
+            }
+            break;
+
+        case SDL_KEYDOWN:
+            if (editor->picker.active) {
+                if (event->key.keysym.sym == SDLK_o && (mod & KMOD_CTRL)) {
+                    closePicker(&editor->picker);
+                    waitDialogProbe(editor->startup);
+                    OpenDialog(&editor->doc, &editor->loader, &editor->paged, &editor->hex, &editor->watch,
+                               &editor->markers, &editor->columns, &editor->current_line, &editor->cursor_pos);
+                } else {
+                    char *path = pickerKey(&editor->picker, event->key.keysym.sym);
+                    if (path) {
+                        openDocument(path, &editor->doc, &editor->loader, &editor->paged, &editor->hex,
+                                     &editor->watch, &editor->markers, &editor->columns, &editor->current_line,
+                                     &editor->cursor_pos);
+                        free(path);
+                    }
+                }
+                break;
+            }
+            if (editor->compare.active) {
+                if (event->key.keysym.sym == SDLK_ESCAPE ||
+                    (event->key.keysym.sym == SDLK_d && (mod & KMOD_CTRL))) {
+                    toggleCompareView(&editor->compare, &editor->doc, &editor->watch, &editor->scroll);
+                }
+                break;
+            }
+            if (editor->hex.path && !viewShortcut(event->key.keysym.sym, mod)) {
+                hexKey(&editor->hex, event->key.keysym.sym);
+                break;
+            }
+            if (editor->paged.data && !viewShortcut(event->key.keysym.sym, mod)) {
+                handlePagedKey(&editor->paged, event->key.keysym.sym, mod, &editor->cursor_pos,
+                               &editor->current_line);
+                break;
+            }
+            switch (event->key.keysym.sym) {
+                case SDLK_LEFT:
+                    if (mod & KMOD_ALT) {
+                        optLeft(&editor->doc, &editor->cursor_pos, editor->current_line);
+                    } else if (mod & KMOD_GUI) {
+                        cmdLeft(&editor->cursor_pos);
+                    } else {
+                        moveCursorLeft(&editor->doc, &editor->cursor_pos, &editor->current_line);
+                    }
+                    break;
 
-        SDL_Surface *lineNumberSurface = TTF_RenderText_Solid(font, line_number, white);
-        if (!lineNumberSurface) {
-            printf("Line number render error: %s\n", TTF_GetError());
-            return;
-        }
+                case SDLK_RIGHT:
+                    if (mod & KMOD_ALT) {
+                        optRight(&editor->doc, &editor->cursor_pos, editor->current_line);
+                    } else if (mod & KMOD_GUI) {
+                        cmdRight(&editor->doc, &editor->cursor_pos, editor->current_line);
+                    } else {
+                        moveCursorRight(&editor->doc, &editor->cursor_pos, &editor->current_line);
+                    }
+                    break;
 
-        SDL_Texture *lineNumberTexture = SDL_CreateTextureFromSurface(renderer, lineNumberSurface);
-        if (!lineNumberTexture) {
-            printf("Line number texture creation error: %s\n", SDL_GetError());
-            SDL_FreeSurface(lineNumberSurface);
-            return;
-        }
+                case SDLK_BACKSPACE:
+                    if (editor->cursor_pos == 0 && editor->current_line > 0) {
+                        columnsEdited(&editor->columns, editor->current_line - 1, 2, 1);
+                    } else {
+                        columnsEdited(&editor->columns, editor->current_line, 1, 1);
+                    }
+                    handleBackspace(&editor->doc, &editor->cursor_pos, &editor->current_line);
+                    markEdited(&editor->markers);
+                    break;
 
-        SDL_Rect lineNumberRect = {5, y + i * lineNumberSurface->h, lineNumberSurface->w, lineNumberSurface->h};
-        SDL_RenderCopy(renderer, lineNumberTexture, nullptr, &lineNumberRect);
+                case SDLK_RETURN:
+                    columnsEdited(&editor->columns, editor->current_line, 1, 2);
+                    handleEnterKey(&editor->doc, &editor->current_line, &editor->cursor_pos);
+                    markEdited(&editor->markers);
+                    break;
 
-        SDL_FreeSurface(lineNumberSurface);
-        SDL_DestroyTexture(lineNumberTexture);
+                case SDLK_UP:
+                    moveCursorUp(&editor->doc, &editor->cursor_pos, &editor->current_line);
+                    break;
+                case SDLK_DOWN:
+                    moveCursorDown(&editor->doc, &editor->cursor_pos, &editor->current_line);
+                    break;
 
-        char newString[MAX_LINE_LENGTH];
-        strcpy(newString, lines[i]);
-        if (newString[0] == '\0') {
-            strcpy(newString, " \0");
-        }
+                case SDLK_s:
+                    if (mod & KMOD_CTRL) {
+                        if (editor->hex.path) {
+                            hexSave(&editor->hex);
+                        } else if (editor->loader.active) {
+                            printf("File is still loading.\n");
+                        } else {
+                            waitDialogProbe(editor->startup);
+                            SaveDialog(&editor->doc, &editor->paged, &editor->watch, &editor->markers);
+                            sessionSetFile(&editor->session,
+                                           editor->paged.data ? editor->paged.path : editor->watch.path);
+                            sessionSaveFolds(&editor->session, editor->paged.data ? nullptr : &editor->doc.folds);
+                        }
+                    }
+                    break;
 
-        SDL_Surface *surfaceMessage = TTF_RenderText_Solid(font, newString, white);
-        if (!surfaceMessage) {
-            printf("Text render error: %s\n", TTF_GetError());
-            return;
-        }
+                case SDLK_o:
+                    if ((mod & KMOD_CTRL) &&
+                        ((mod & KMOD_SHIFT) || openPicker(&editor->picker, editor->watch.path) != 0)) {
+                        waitDialogProbe(editor->startup);
+                        OpenDialog(&editor->doc, &editor->loader, &editor->paged, &editor->hex, &editor->watch,
+                                   &editor->markers, &editor->columns, &editor->current_line, &editor->cursor_pos);
+                    }
+                    break;
 
-        SDL_Texture *messageTexture = SDL_CreateTextureFromSurface(renderer, surfaceMessage);
-        if (!messageTexture) {
-            printf("Texture creation error: %s\n", SDL_GetError());
-            SDL_FreeSurface(surfaceMessage);
-            return;
-        }
+                case SDLK_d:
+                    if (mod & KMOD_CTRL) {
+                        if (editor->paged.data || editor->hex.path || editor->loader.active) {
+                            printf("Compare is not available for this file.\n");
+                        } else {
+                            toggleCompareView(&editor->compare, &editor->doc, &editor->watch, &editor->scroll);
+                        }
+                    }
+                    break;
 
-        SDL_Rect messageRect = {x, y + i * surfaceMessage->h, surfaceMessage->w, surfaceMessage->h};
-        if (messageRect.y + messageRect.h > 0 && messageRect.y < window_height) {
-            SDL_RenderCopy(renderer, messageTexture, nullptr, &messageRect);
-        }
-        SDL_RenderCopy(renderer, messageTexture, nullptr, &messageRect);
+                case SDLK_LEFTBRACKET:
+                    if (mod & KMOD_CTRL) {
+                        if (mod & KMOD_SHIFT) {
+                            toggleAllFolds(&editor->doc, &editor->current_line, &editor->cursor_pos);
+                        } else {
+                            toggleFold(&editor->doc, editor->current_line);
+                        }
+                        sessionSaveFolds(&editor->session, &editor->doc.folds);
+                    }
+                    break;
 
-        if (i == current_line) {
-            if (cursor_pos > 0) {
-                char temp[MAX_LINE_LENGTH] = {0};
-                strncpy(temp, newString, cursor_pos);
-                SDL_Surface *surfaceCursor = TTF_RenderText_Solid(font, temp, white);
-                if (surfaceCursor == NULL) {
-                    printf("SDL_Init Error: %s\n", SDL_GetError());
-                }
+                case SDLK_t:
+                    if (mod & KMOD_CTRL) {
+                        toggleFollow(&editor->watch, &editor->doc, &editor->scroll, editor->line_height,
+                                     editor->window_height);
+                    }
+                    break;
+
+                case SDLK_k:
+                    if (mod & KMOD_CTRL) {
+                        if (editor->paged.data || editor->hex.path) {
+                            printf("Column view is not available for this file.\n");
+                        } else if (toggleColumns(&editor->columns, &editor->doc) != 0) {
+                            printf("No delimiter found for the column view.\n");
+                        } else {
+                            printf("Column view %s.\n", editor->columns.active ? "on" : "off");
+                        }
+                    }
+                    break;
+
+                case SDLK_F5:
+                    applyLineCommand(&editor->doc, &editor->loader, &editor->markers, &editor->columns,
+                                     (mod & KMOD_SHIFT) ? LINES_SORT_NUMERIC : LINES_SORT, &editor->current_line,
+                                     &editor->cursor_pos);
+                    break;
+                case SDLK_F6:
+                    applyLineCommand(&editor->doc, &editor->loader, &editor->markers, &editor->columns, LINES_UNIQUE,
+                                     &editor->current_line, &editor->cursor_pos);
+                    break;
+                case SDLK_F7:
+                    applyLineCommand(&editor->doc, &editor->loader, &editor->markers, &editor->columns, LINES_REVERSE,
+                                     &editor->current_line, &editor->cursor_pos);
+                    break;
+                case SDLK_F8:
+                    applyLineCommand(&editor->doc, &editor->loader, &editor->markers, &editor->columns, LINES_SHUFFLE,
+                                     &editor->current_line, &editor->cursor_pos);
+                    break;
 
-                cursor_x = x + surfaceCursor->w;
-                SDL_FreeSurface(surfaceCursor);
+                case SDLK_ESCAPE:
+                    cancelLoad(&editor->loader);
+                    break;
             }
-            cursor_y = y + i * surfaceMessage->h + 4;
-            
-        }
-        SDL_FreeSurface(surfaceMessage);
-        SDL_DestroyTexture(messageTexture);
+            break;
+        case SDL_MOUSEWHEEL:
+            if (!editor->picker.active) {
+                handleScroll(*event, &editor->scroll);
+            }
+            break;
+        default:
+            if (event->type == editor->loader.event_type) {
+                SDL_bool pinned = editor->loader.stream &&
+                                  scrollReaches(&editor->scroll, bottomScrollOffset(&editor->doc, editor->line_height,
+                                                                                    editor->window_height));
+                if (drainLoader(&editor->loader, &editor->doc)) {
+                    if (!editor->loader.stream) {
+                        watchFile(&editor->watch, editor->loader.path);
+                    }
+                    setBaseline(&editor->markers, &editor->doc);
+                    if (editor->session.pending && sessionRestores(&editor->session, editor->loader.path)) {
+                        restoreSession(&editor->session, &editor->doc, &editor->paged, &editor->scroll,
+                                       &editor->cursor_pos, &editor->current_line, editor->line_height,
+                                       editor->window_height);
+                    }
+                    if (!editor->loader.stream) {
+                        sessionSetFile(&editor->session, editor->loader.path);
+                    }
+                }
+                if (!editor->loader.active) {
+                    editor->session.pending = SDL_FALSE;
+                }
+                if (pinned) {
+                    scrollJump(&editor->scroll,
+                               bottomScrollOffset(&editor->doc, editor->line_height, editor->window_height));
+                }
+            } else if (event->type == editor->watch.event_type) {
+                handleExternalChange(&editor->watch, &editor->doc, &editor->markers, &editor->columns,
+                                     &editor->cursor_pos, &editor->current_line, &editor->scroll, editor->line_height,
+                                     editor->window_height);
+            } else if (event->type == editor->instance.event_type) {
+                char *path = event->user.data1;
+                if (path) {
+                    closePicker(&editor->picker);
+                    if (editor->compare.active) {
+                        toggleCompareView(&editor->compare, &editor->doc, &editor->watch, &editor->scroll);
+                    }
+                    openDocument(path, &editor->doc, &editor->loader, &editor->paged, &editor->hex, &editor->watch,
+                                 &editor->markers, &editor->columns, &editor->current_line, &editor->cursor_pos);
+                    free(path);
+                }
+                editor->raise_count++;
+            } else if (event->type == editor->scroll.event_type) {
+                stepScroll(&editor->scroll);
+            }
+            break;
     }
-
-    SDL_Rect cursorRect = {cursor_x, cursor_y, 2, FONT_SIZE};
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(renderer, &cursorRect);
+    return event->type != SDL_MOUSEWHEEL && event->type != editor->scroll.event_type;
 }
 
-void handleScroll(SDL_Event event, int *scroll_offset) {
-    if (event.type == SDL_MOUSEWHEEL) {
-        *scroll_offset -= event.wheel.y * SCROLL_SPEED;
-        if (*scroll_offset < 0)
-            *scroll_offset = 0;
+void publishView(Editor *editor, SDL_bool changed) {
+    int margin = SCROLL_OVERSCAN_ROWS * editor->line_height;
+    int height = editor->window_height + 2 * margin;
+    ViewSnapshot *snapshot = acquireSnapshot(&editor->exchange, height / editor->line_height + 2);
+    if (snapshot == nullptr) {
+        printf("Error: Not enough memory for the view snapshot.\n");
+        return;
+    }
+    editor->version++;
+    editor->content += changed;
+    snapshot->version = editor->version;
+    snapshot->content = editor->content;
+    snapshot->events = editor->handled;
+    snapshot->raise_count = editor->raise_count;
+    snapshot->window_width = editor->window_width;
+    snapshot->window_height = editor->window_height;
+    snapshot->height = height;
+
+    if (editor->picker.active) {
+        snapshotPicker(snapshot, &editor->picker, editor->line_height);
+    } else {
+        setScrollLimit(&editor->scroll, viewScrollLimit(&editor->doc, &editor->paged, &editor->hex, &editor->compare,
+                                                        editor->line_height, editor->window_height));
+        snapshot->row = editor->scroll.row;
+        snapshot->position = editor->scroll.position;
+        snapshot->top_row = overscanRow(snapshot->row);
+        if (editor->compare.active) {
+            snapshotDocument(snapshot, &editor->compare.lines, nullptr, editor->compare.marks,
+                             editor->compare.lines.line_count, 0, -1, editor->line_height);
+        } else if (editor->hex.path) {
+            snapshotHex(snapshot, &editor->hex, editor->line_height);
+        } else if (editor->paged.data) {
+            snapshotPaged(snapshot, &editor->paged, editor->cursor_pos, editor->current_line, editor->line_height);
+        } else {
+            SDL_bool aligned = editor->columns.active &&
+                               updateColumns(&editor->columns, &editor->doc, SDL_GetCPUCount()) == 0;
+            snapshotDocument(snapshot, &editor->doc, aligned ? &editor->columns : nullptr, editor->markers.marks,
+                             editor->markers.mark_count, editor->cursor_pos, editor->current_line,
+                             editor->line_height);
+        }
+    }
+    publishSnapshot(&editor->exchange, snapshot);
+
+    const char *path = editor->paged.data ? editor->paged.path : editor->watch.path;
+    if (!editor->session.pending && !editor->loader.active && !editor->picker.active && !editor->compare.active &&
+        !editor->hex.path) {
+        ScrollOffset target = scrollTarget(&editor->scroll);
+        sessionTrack(&editor->session, path, editor->cursor_pos, editor->current_line, target.row, (int) target.pixel);
+    }
+    if (editor->hex.path) {
+        size_t rows = hexRowCount(&editor->hex);
+        instancePublish(&editor->instance, editor->hex.path, (int) (editor->hex.cursor / HEX_ROW_BYTES) + 1,
+                        (int) (editor->hex.cursor % HEX_ROW_BYTES) + 1,
+                        rows < SDL_MAX_SINT32 ? (int) rows : SDL_MAX_SINT32);
+    } else {
+        instancePublish(&editor->instance, editor->paged.data || !editor->loader.active ? path : editor->loader.path,
+                        editor->current_line + 1, editor->cursor_pos + 1,
+                        editor->paged.data ? (int) pagedLineCount(&editor->paged) : editor->doc.line_count);
     }
 }
 
-void handleTextInput(char lines[MAX_LINES][MAX_LINE_LENGTH], const char *input, int *cursor_pos, int current_line) {
-    int len = strlen(lines[current_line]);
-    int input_len = strlen(input);
+void renderText(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view, int x, int y,
+                Sint64 top_row, int window_height) {
+    int line_height = glyphs->cell_height;
+    int cursor_x = x;
 
-    if (len + input_len >= MAX_LINE_LENGTH) {
-        printf("Line buffer is full!\n");
-        return;
+    for (int i = 0; i < view->row_count; i++) {
+        const SnapshotRow *row = &view->rows[i];
+        Sint64 row_index = view->first_row + i;
+        int row_y = y + (int) (row_index - top_row) * line_height;
+        if (row_y + line_height <= 0 || row_y >= window_height) {
+            continue;
+        }
+        int line_cursor = row_index == view->cursor_row ? view->cursor_pos : -1;
+        if (view->delimiter ? renderCells(renderer, glyphs, arena, view, row->text, row->line_number, row->mark, x,
+                                          row_y, line_cursor, &cursor_x) != 0
+                            : renderLine(renderer, glyphs, arena, row->text, row->line_number, row->mark, x, row_y,
+                                         line_cursor, &cursor_x) != 0) {
+            return;
+        }
+        char *fold_text = row->folded ? arenaPrintf(arena, "... %d lines", row->folded) : nullptr;
+        if (fold_text) {
+            int text_width = view->delimiter ? view->offsets[view->column_count] * cellAdvance(glyphs)
+                                             : measureText(glyphs, row->text, strlen(row->text));
+            renderRun(renderer, glyphs, arena, fold_text, x + text_width + glyphs->cell_width, row_y);
+        }
     }
 
-    memmove(lines[current_line] + *cursor_pos + input_len, lines[current_line] + *cursor_pos, len - *cursor_pos + 1);
-    memcpy(lines[current_line] + *cursor_pos, input, input_len);
-    *cursor_pos += input_len;
+    Sint64 cursor_y = y + (view->cursor_row - top_row) * line_height;
+    if (view->cursor_row >= 0 && cursor_y + line_height > 0 && cursor_y < window_height) {
+        renderCursor(renderer, cursor_x, (int) cursor_y + 4);
+    }
 }
 
-void handleEnterKey(char lines[MAX_LINES][MAX_LINE_LENGTH], int *current_line, int *cursor_pos, int *line_count) {
-    if (*line_count >= MAX_LINES - 1) {
-        return;
+void renderHexView(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view, int x,
+                   int y, Sint64 top_row, int window_height) {
+    int line_height = glyphs->cell_height;
+    int cell_width = cellAdvance(glyphs);
+
+    for (int i = 0; i < view->row_count; i++) {
+        const SnapshotRow *row = &view->rows[i];
+        int row_y = y + (int) (view->first_row + i - top_row) * line_height;
+        if (row_y + line_height <= 0 || row_y >= window_height) {
+            continue;
+        }
+        SDL_SetRenderDrawColor(renderer, 90, 70, 30, 255);
+        for (int b = 0; b < HEX_ROW_BYTES; b++) {
+            if (row->patched >> b & 1) {
+                SDL_Rect cell = {x + (view->offset_digits + 2 + b * 3) * cell_width, row_y, 2 * cell_width,
+                                 line_height};
+                SDL_RenderFillRect(renderer, &cell);
+            }
+        }
+        if (renderRun(renderer, glyphs, arena, row->text, x, row_y) != 0) {
+            printf("Text render error: frame arena exhausted\n");
+            return;
+        }
     }
 
-    insertLine(lines, *current_line + 1, *line_count);
-    memcpy(lines[*current_line + 1], lines[*current_line] + *cursor_pos, (MAX_LINE_LENGTH - 1) * sizeof(char));
-    lines[*current_line][*cursor_pos] = '\0';
+    Sint64 cursor_y = y + (view->cursor_row - top_row) * line_height;
+    if (cursor_y + line_height > 0 && cursor_y < window_height) {
+        renderCursor(renderer, x + view->cursor_pos * cell_width, (int) cursor_y + 4);
+    }
+}
 
-    *cursor_pos = 0;
-    (*line_count)++;
+int renderLine(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const char *text, long line_number,
+               int mark, int x, int y, int cursor_pos, int *cursor_x) {
+    renderMark(renderer, mark, y, glyphs->cell_height);
+    char *line_number_text = arenaPrintf(arena, "%ld", line_number);
+    if (!line_number_text || renderRun(renderer, glyphs, arena, line_number_text, 5, y) != 0 ||
+        renderRun(renderer, glyphs, arena, text, x, y) != 0) {
+        printf("Text render error: frame arena exhausted\n");
+        return 1;
+    }
 
-    moveCursorDown(lines, cursor_pos, current_line, *line_count);
+    if (cursor_pos > 0) {
+        *cursor_x = x + measureText(glyphs, text, cursor_pos);
+    }
+    return 0;
 }
 
-void insertLine(char lines[MAX_LINES][MAX_LINE_LENGTH], int index, int line_count) {
-    memmove(&lines[index + 1], &lines[index], (line_count - index) * sizeof(lines[0]));
-    memset(lines[index], 0, sizeof(lines[0]));
+int renderCells(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view,
+                const char *text, long line_number, int mark, int x, int y, int cursor_pos, int *cursor_x) {
+    SDL_Rect viewport;
+    SDL_RenderGetViewport(renderer, &viewport);
+    renderMark(renderer, mark, y, glyphs->cell_height);
+    char *line_number_text = arenaPrintf(arena, "%ld", line_number);
+    if (!line_number_text || renderRun(renderer, glyphs, arena, line_number_text, 5, y) != 0) {
+        printf("Text render error: frame arena exhausted\n");
+        return 1;
+    }
+
+    int length = strlen(text);
+    for (int pos = 0, column = 0; column < view->column_count; pos++, column++) {
+        int end = columnFieldEnd(view->delimiter, text, pos);
+        int cell_x = x + view->offsets[column] * cellAdvance(glyphs);
+        if (cursor_pos >= pos && cursor_pos <= end) {
+            *cursor_x = cell_x + measureText(glyphs, text + pos, cursor_pos - pos);
+        }
+        if (cell_x >= viewport.w) {
+            break;
+        }
+        char *cell = arenaPrintf(arena, "%.*s", end - pos, text + pos);
+        if (!cell || renderRun(renderer, glyphs, arena, cell, cell_x, y) != 0) {
+            printf("Text render error: frame arena exhausted\n");
+            return 1;
+        }
+        if (end >= length) {
+            break;
+        }
+        pos = end;
+    }
+    return 0;
 }
 
-void removeLine(char lines[MAX_LINES][MAX_LINE_LENGTH], int index, int *line_count) {
-    if (index < 0 || index >= *line_count) {
+void renderPicker(SDL_Renderer *renderer, GlyphCache *glyphs, FrameArena *arena, const ViewSnapshot *view) {
+    int line_height = glyphs->cell_height;
+    if (renderRun(renderer, glyphs, arena, view->header, 5, 10) != 0) {
+        printf("Text render error: frame arena exhausted\n");
         return;
     }
+    renderCursor(renderer, 5 + measureText(glyphs, view->header, strlen(view->header)), 14);
+
+    int top = 10 + 2 * line_height;
+    for (int i = 0; i < view->row_count; i++) {
+        int y = top + i * line_height;
+        if (i == view->selected) {
+            SDL_Rect highlight = {0, y, view->window_width, line_height};
+            SDL_SetRenderDrawColor(renderer, 50, 60, 90, 255);
+            SDL_RenderFillRect(renderer, &highlight);
+        }
+        if (renderRun(renderer, glyphs, arena, view->rows[i].text, 50, y) != 0) {
+            printf("Text render error: frame arena exhausted\n");
+            return;
+        }
+    }
+}
 
-    if (index < *line_count - 1) {
-        memmove(lines + index, lines + index + 1, (*line_count - index - 1) * sizeof(lines[0]));
+void renderMark(SDL_Renderer *renderer, int mark, int y, int height) {
+    SDL_Rect markRect = {0, y, 3, height};
+    switch (mark) {
+        case MARK_ADDED:
+            SDL_SetRenderDrawColor(renderer, 80, 200, 120, 255);
+            break;
+        case MARK_CHANGED:
+            SDL_SetRenderDrawColor(renderer, 90, 150, 240, 255);
+            break;
+        case MARK_REMOVED:
+            SDL_SetRenderDrawColor(renderer, 230, 80, 80, 255);
+            markRect.y = y + height - 3;
+            markRect.w = 12;
+            markRect.h = 3;
+            break;
+        case MARK_HEADER:
+            SDL_SetRenderDrawColor(renderer, 160, 160, 160, 255);
+            break;
+        default:
+            return;
     }
+    SDL_RenderFillRect(renderer, &markRect);
+}
 
-    memset(lines[*line_count - 1], 0, sizeof(lines[0]));
-    (*line_count)--;
+void renderCursor(SDL_Renderer *renderer, int cursor_x, int cursor_y) {
+    SDL_Rect cursorRect = {cursor_x, cursor_y, 2, FONT_SIZE};
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderFillRect(renderer, &cursorRect);
 }
 
-void handleBackspace(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line, int *line_count) {
-    if (*cursor_pos > 0) {
-        int len = strlen(lines[*current_line]);
-        memmove(lines[*current_line] + *cursor_pos - 1, lines[*current_line] + *cursor_pos, len - *cursor_pos + 1);
-        (*cursor_pos)--;
-    } else if (*current_line > 0) {
-        int prev_len = strlen(lines[*current_line - 1]);
-        int cur_len = strlen(lines[*current_line]);
+void handlePagedTextInput(PagedFile *paged, const char *input, int *cursor_pos, int current_line) {
+    char text[MAX_LINE_LENGTH];
+    char *lines[] = {text};
+    Document line_view = {.lines = lines, .line_count = 1, .capacity = 1};
 
-        if (prev_len + cur_len < MAX_LINE_LENGTH) {
-            strcat(lines[*current_line - 1], lines[*current_line]);
-            *cursor_pos = prev_len;
-        }
-        removeLine(lines, *current_line, line_count);
-        (*current_line)--;
+    if (pagedGetLine(paged, current_line, text) >= MAX_LINE_LENGTH) {
+        printf("Line is too long to edit in paged mode.\n");
+        return;
     }
+    handleTextInput(&line_view, input, cursor_pos, 0);
+    pagedSetLine(paged, current_line, text);
 }
 
-void moveCursorLeft(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line) {
-    if (*cursor_pos > 0) {
-        (*cursor_pos)--;
-    } else if (*current_line > 0) {
-        (*current_line)--;
-        *cursor_pos = strlen(lines[*current_line]);
-    }
+SDL_bool viewShortcut(SDL_Keycode key, SDL_Keymod mod) {
+    return (mod & KMOD_CTRL) && (key == SDLK_s || key == SDLK_o || key == SDLK_d || key == SDLK_t || key == SDLK_k);
 }
 
-void moveCursorRight(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line) {
-    int len = strlen(lines[*current_line]);
-    if (*cursor_pos < len) {
-        (*cursor_pos)++;
-    } else if (*current_line < MAX_LINES - 1 && lines[*current_line + 1][0] != '\0') {
-        (*current_line)++;
-        *cursor_pos = 0;
+void handlePagedKey(PagedFile *paged, SDL_Keycode key, SDL_Keymod mod, int *cursor_pos, int *current_line) {
+    char text[MAX_LINE_LENGTH];
+    char *lines[] = {text};
+    Document line_view = {.lines = lines, .line_count = 1, .capacity = 1};
+    SDL_bool editable = pagedGetLine(paged, *current_line, text) < MAX_LINE_LENGTH;
+    int len = strlen(text);
+    int view_line = 0;
+
+    switch (key) {
+        case SDLK_LEFT:
+            if (mod & KMOD_ALT) {
+                optLeft(&line_view, cursor_pos, 0);
+            } else if (mod & KMOD_GUI) {
+                cmdLeft(cursor_pos);
+            } else if (*cursor_pos > 0) {
+                *cursor_pos = utf8Prev(text, *cursor_pos);
+            } else if (*current_line > 0) {
+                (*current_line)--;
+                pagedGetLine(paged, *current_line, text);
+                *cursor_pos = strlen(text);
+            }
+            break;
+
+        case SDLK_RIGHT:
+            if (mod & KMOD_ALT) {
+                optRight(&line_view, cursor_pos, 0);
+            } else if (mod & KMOD_GUI) {
+                cmdRight(&line_view, cursor_pos, 0);
+            } else if (*cursor_pos < len) {
+                *cursor_pos = utf8Next(text, *cursor_pos);
+            } else {
+                pagedEnsureLines(paged, *current_line + 2);
+                if (*current_line < pagedLineCount(paged) - 1) {
+                    (*current_line)++;
+                    *cursor_pos = 0;
+                }
+            }
+            break;
+
+        case SDLK_UP:
+        case SDLK_DOWN:
+            if (key == SDLK_DOWN) {
+                pagedEnsureLines(paged, *current_line + 2);
+                if (*current_line >= pagedLineCount(paged) - 1) {
+                    break;
+                }
+                (*current_line)++;
+            } else if (*current_line > 0) {
+                (*current_line)--;
+            }
+            pagedGetLine(paged, *current_line, text);
+            *cursor_pos = utf8Snap(text, *cursor_pos);
+            break;
+
+        case SDLK_BACKSPACE:
+            if (!editable) {
+                printf("Line is too long to edit in paged mode.\n");
+            } else if (*cursor_pos > 0) {
+                handleBackspace(&line_view, cursor_pos, &view_line);
+                pagedSetLine(paged, *current_line, text);
+            } else if (*current_line > 0) {
+                char previous[MAX_LINE_LENGTH];
+                int prev_len = pagedGetLine(paged, *current_line - 1, previous);
+                if (prev_len + len < MAX_LINE_LENGTH) {
+                    strcat(previous, text);
+                    pagedSetLine(paged, *current_line - 1, previous);
+                    pagedRemoveLine(paged, *current_line);
+                    (*current_line)--;
+                    *cursor_pos = prev_len;
+                }
+            }
+            break;
+
+        case SDLK_RETURN:
+            if (!editable) {
+                printf("Line is too long to edit in paged mode.\n");
+            } else if (pagedInsertLine(paged, *current_line + 1, text + *cursor_pos) == 0) {
+                text[*cursor_pos] = '\0';
+                pagedSetLine(paged, *current_line, text);
+                (*current_line)++;
+                *cursor_pos = 0;
+            }
+            break;
     }
 }
 
+SDL_bool handleScroll(SDL_Event event, SmoothScroll *scroll) {
+    if (event.type != SDL_MOUSEWHEEL) {
+        return SDL_FALSE;
+    }
+    double delta = event.wheel.preciseY != 0 ? event.wheel.preciseY : event.wheel.y;
+    return scrollBy(scroll, -delta * SCROLL_SPEED);
+}
 
-void moveCursorUp(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line) {
-    if (*current_line <= 0) {
-        *current_line = 0;
+void toggleFold(Document *doc, int current_line) {
+    if (removeFold(&doc->folds, current_line)) {
         return;
     }
-
-    (*current_line)--;
-    int len = strlen(lines[*current_line]);
-    if (*cursor_pos > len) {
-        *cursor_pos = len;
+    int end = foldRegionEnd(doc->lines, doc->line_count, current_line);
+    if (end <= current_line) {
+        printf("Nothing to fold at line %d.\n", current_line + 1);
+        return;
     }
+    addFold(&doc->folds, current_line + 1, end);
 }
 
-void moveCursorDown(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int *current_line, int line_count) {
-    if (*current_line >= line_count - 1) {
-        *current_line = line_count - 1;
+void toggleAllFolds(Document *doc, int *current_line, int *cursor_pos) {
+    if (hiddenLineCount(&doc->folds) > 0) {
+        clearFolds(&doc->folds);
         return;
     }
-
-    (*current_line)++;
-    int len = strlen(lines[*current_line]);
-    if (*cursor_pos > len) {
-        *cursor_pos = len;
+    for (int line = 0; line < doc->line_count; line++) {
+        int end = foldRegionEnd(doc->lines, doc->line_count, line);
+        if (end > line) {
+            addFold(&doc->folds, line + 1, end);
+            line = end;
+        }
+    }
+    const FoldNode *fold = findFold(&doc->folds, *current_line);
+    if (fold) {
+        *current_line = fold->start - 1;
+        *cursor_pos = utf8Snap(doc->lines[*current_line], *cursor_pos);
     }
 }
 
-void optLeft(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int current_line) {
-    int i = *cursor_pos - 1;
-
-    while (i >= 0 && lines[current_line][i] == ' ') {
-        i--;
+void applyLineCommand(Document *doc, Loader *loader, ChangeMarkers *markers, ColumnView *columns, int command,
+                      int *current_line, int *cursor_pos) {
+    if (loader->active) {
+        printf("File is still loading.\n");
+        return;
     }
-
-    while (i >= 0 && lines[current_line][i] != ' ') {
-        i--;
+    int line_count = doc->line_count;
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (runLineCommand(doc, command, 0, line_count, SDL_GetCPUCount()) != 0) {
+        printf("Error: Not enough memory to %s %d lines.\n", lineCommandName(command), line_count);
+        return;
     }
+    double elapsed = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    printf("Ran %s on %d lines in %.1f ms", lineCommandName(command), line_count, elapsed);
+    if (command == LINES_UNIQUE) {
+        printf(", removed %d duplicates", line_count - doc->line_count);
+    }
+    printf(".\n");
 
-    *cursor_pos = i + 1;
+    if (*current_line >= doc->line_count) {
+        *current_line = doc->line_count - 1;
+    }
+    *cursor_pos = utf8Snap(doc->lines[*current_line], *cursor_pos);
+    resetColumns(columns);
+    markEdited(markers);
 }
 
-void optRight(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int current_line) {
-    int len = strlen(lines[current_line]);
-    int i = *cursor_pos;
+ScrollOffset bottomScrollOffset(Document *doc, int line_height, int window_height) {
+    return scrollOffset(doc->line_count - hiddenLineCount(&doc->folds), 50 - window_height, line_height);
+}
 
-    while (i < len && lines[current_line][i] == ' ') {
-        i++;
+ScrollOffset viewScrollLimit(Document *doc, PagedFile *paged, HexView *hex, CompareView *compare, int line_height,
+                             int window_height) {
+    if (compare->active) {
+        return bottomScrollOffset(&compare->lines, line_height, window_height);
     }
-
-    while (i < len && lines[current_line][i] != ' ') {
-        i++;
+    if (paged->data || hex->path) {
+        Sint64 rows = paged->data ? pagedLineCount(paged) : (Sint64) hexRowCount(hex);
+        return scrollOffset(rows, 50 - window_height, line_height);
     }
-
-    *cursor_pos = i;
+    return bottomScrollOffset(doc, line_height, window_height);
 }
 
-void cmdRight(char lines[MAX_LINES][MAX_LINE_LENGTH], int *cursor_pos, int current_line) {
-    int len = strlen(lines[current_line]);
-    *cursor_pos = len;
+void toggleFollow(FileWatch *watch, Document *doc, SmoothScroll *scroll, int line_height, int window_height) {
+    if (watch->path == nullptr) {
+        printf("Follow mode needs an open file.\n");
+        return;
+    }
+    watch->follow = !watch->follow;
+    printf("Follow mode %s for %s.\n", watch->follow ? "on" : "off", watch->path);
+    if (watch->follow) {
+        scrollJump(scroll, bottomScrollOffset(doc, line_height, window_height));
+    }
 }
 
-void cmdLeft(int *cursor_pos) {
-    *cursor_pos = 0;
+void handleExternalChange(FileWatch *watch, Document *doc, ChangeMarkers *markers, ColumnView *columns, int *cursor_pos,
+                          int *current_line, SmoothScroll *scroll, int line_height, int window_height) {
+    if (doc->modified) {
+        printf("%s changed on disk; keeping unsaved edits.\n", watch->path);
+        return;
+    }
+    if (!plainTextFormat(&doc->format)) {
+        printf("%s changed on disk; reopen it to reload.\n", watch->path);
+        return;
+    }
+
+    SDL_bool pinned = watch->follow && scrollReaches(scroll, bottomScrollOffset(doc, line_height, window_height));
+    ReloadRegion region;
+    if (reloadChanges(watch, doc, &region) != 0) {
+        return;
+    }
+    patchBaseline(markers, doc, region.first_line, region.removed, region.inserted);
+    columnsEdited(columns, region.first_line, region.removed, region.inserted);
+
+    int delta = region.inserted - region.removed;
+    if (*current_line >= region.first_line + region.removed) {
+        *current_line += delta;
+    } else if (*current_line >= region.first_line + region.inserted) {
+        *current_line = region.first_line + region.inserted - 1;
+    }
+    if (*current_line >= doc->line_count) {
+        *current_line = doc->line_count - 1;
+    }
+    if (*current_line < 0) {
+        *current_line = 0;
+    }
+    *cursor_pos = utf8Snap(doc->lines[*current_line], *cursor_pos);
+
+    if (pinned) {
+        scrollJump(scroll, bottomScrollOffset(doc, line_height, window_height));
+    } else if (scrollReaches(scroll, (ScrollOffset) {region.first_line + region.removed, 0})) {
+        scrollShift(scroll, delta);
+    }
 }
 
-void OpenDialog(char lines[MAX_LINES][MAX_LINE_LENGTH], int *line_count, int *current_line, int *cursor_pos) {
-    
-    for (int i = 0; i < MAX_LINES; i++) {
-        lines[i][0] = '\0';
+void toggleCompareView(CompareView *compare, Document *doc, FileWatch *watch, SmoothScroll *scroll) {
+    if (compare->active) {
+        closeCompareView(compare);
+        scrollJump(scroll, compare->saved_scroll);
+    } else if (watch->path == nullptr) {
+        printf("Nothing to compare: the document has no file on disk.\n");
+    } else if (openCompareView(compare, doc, watch->path) == 0) {
+        compare->saved_scroll = scrollTarget(scroll);
+        scrollJump(scroll, (ScrollOffset) {0, 0});
     }
+}
 
+void OpenDialog(Document *doc, Loader *loader, PagedFile *paged, HexView *hex, FileWatch *watch,
+                ChangeMarkers *markers, ColumnView *columns, int *current_line, int *cursor_pos) {
     const char *openPath = tinyfd_openFileDialog(
             "Open Text File",
             "",
-            1,
-            (const char *[]) {"*.txt"},
+            3,
+            (const char *[]) {"*.txt", "*.gz", "*.zst"},
             "Text files",
             0
     );
 
     if (openPath) {
-        FILE *file = fopen(openPath, "r");
-        if (file == NULL) {
-            printf("Error: Could not open file for reading.\n");
-            return;
-        }
-        *current_line = 0;
-        *cursor_pos = 0;
-        int i = 0;
-        while (i < MAX_LINES && fgets(lines[i], MAX_LINE_LENGTH, file)) {
-            lines[i][strcspn(lines[i], "\n")] = '\0';
-            i++;
-        }
+        openDocument(openPath, doc, loader, paged, hex, watch, markers, columns, current_line, cursor_pos);
+    } else {
+        printf("Open dialog was canceled.\n");
+    }
+}
 
-        for (i = 0; i < MAX_LINES; i++) {
-            if (lines[i][0] != '\0') {
-                *line_count = i + 1;
-            }
+void openDocument(const char *path, Document *doc, Loader *loader, PagedFile *paged, HexView *hex, FileWatch *watch,
+                  ChangeMarkers *markers, ColumnView *columns, int *current_line, int *cursor_pos) {
+    stopLoad(loader, doc);
+    unwatchFile(watch);
+    freeMarkers(markers);
+    pagedClose(paged);
+    hexClose(hex);
+    clearDocument(doc);
+    openColumns(columns, path);
+    *current_line = 0;
+    *cursor_pos = 0;
+    SDL_bool plain = strcmp(path, "-") != 0 && detectCompression(path) == COMPRESSION_NONE;
+    if (plain && hexWanted(path) && hexOpen(hex, path) == 0) {
+        return;
+    }
+    if (!plain || !pagedWanted(path) || pagedOpen(paged, path) != 0) {
+        startLoad(loader, path);
+    }
+}
+
+
+void restoreSession(Session *session, Document *doc, PagedFile *paged, SmoothScroll *scroll, int *cursor_pos,
+                    int *current_line, int line_height, int window_height) {
+    SessionData *data = session->data;
+    char text[MAX_LINE_LENGTH];
+    int line_count;
+    session->pending = SDL_FALSE;
+    if (paged->data) {
+        long lines = (long) data->scroll_row + window_height / line_height + 1;
+        pagedEnsureLines(paged, (lines > data->current_line ? lines : data->current_line) + 1);
+        line_count = pagedLineCount(paged) < SDL_MAX_SINT32 ? (int) pagedLineCount(paged) : SDL_MAX_SINT32;
+    } else {
+        if (sessionUnchanged(session)) {
+            sessionRestoreFolds(session, &doc->folds, doc->line_count);
         }
+        line_count = doc->line_count;
+    }
+    if (line_count == 0) {
+        return;
+    }
 
-        fclose(file);
+    *current_line = data->current_line < line_count ? data->current_line : line_count - 1;
+    if (*current_line < 0) {
+        *current_line = 0;
+    }
+    const char *line = text;
+    if (paged->data) {
+        pagedGetLine(paged, *current_line, text);
     } else {
-        printf("Open dialog was canceled.\n");
+        const FoldNode *fold = findFold(&doc->folds, *current_line);
+        if (fold) {
+            *current_line = fold->start - 1;
+        }
+        line = doc->lines[*current_line];
     }
+    *cursor_pos = utf8Snap(line, data->cursor_pos < 0 ? 0 : data->cursor_pos);
+    scrollJump(scroll, scrollOffset(data->scroll_row, data->scroll_pixel, line_height));
 }
 
-
-void SaveDialog(char lines[MAX_LINES][MAX_LINE_LENGTH]) {
+void SaveDialog(Document *doc, PagedFile *paged, FileWatch *watch, ChangeMarkers *markers) {
     const char *savePath = tinyfd_saveFileDialog(
             "Save Text File",
             "untitled.txt",
-            1,
-            (const char*[]){"*.txt"},
+            3,
+            (const char*[]){"*.txt", "*.gz", "*.zst"},
             "Text files");
 
-    if (savePath) {
-        FILE *file = fopen(savePath, "w");
+    if (savePath && paged->data) {
+        pagedSave(paged, savePath);
+    } else if (savePath) {
+        size_t length = strlen(savePath);
+        char *temp_path = malloc(length + 5);
+        if (temp_path == nullptr) {
+            printf("Error: Not enough memory to save %s.\n", savePath);
+            return;
+        }
+        snprintf(temp_path, length + 5, "%s.tmp", savePath);
+        FILE *file = fopen(temp_path, "wb");
+        Stream stream;
         if (file == NULL) {
             printf("Error: Could not open file for writing.\n");
+            free(temp_path);
+            return;
+        }
+        if (openWriteStream(&stream, file, compressionForPath(savePath)) != 0) {
+            fclose(file);
+            remove(temp_path);
+            free(temp_path);
             return;
         }
 
-        for (int i = 0; i < MAX_LINES; ++i) {
-            fprintf(file, "%s\n", lines[i]);
+        int result = writeTextStart(&stream, &doc->format);
+        for (int i = 0; i < doc->line_count && result == 0; ++i) {
+            result = writeTextLine(&stream, &doc->format, doc->lines[i],
+                                   i + 1 < doc->line_count || doc->format.final_newline);
         }
 
-        fclose(file);
+        SDL_bool failed = closeStream(&stream) != 0 || result != 0;
+        failed = fclose(file) != 0 || failed;
+#ifndef _WIN32
+        struct stat st;
+        if (!failed && stat(savePath, &st) == 0) {
+            chmod(temp_path, st.st_mode & 07777);
+        }
+#endif
+        if (failed || rename(temp_path, savePath) != 0) {
+            printf("Error: Could not write %s.\n", savePath);
+            remove(temp_path);
+            free(temp_path);
+            return;
+        }
+        free(temp_path);
+        doc->format.compression = stream.compression;
+        doc->modified = 0;
+        watchFile(watch, savePath);
+        setBaseline(markers, doc);
     } else {
         printf("Save dialog was canceled.\n");
     }
@@ -0,0 +1,482 @@
+#include "paged.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define MADV_SEQUENTIAL 0
+#define MADV_WILLNEED 0
+#define MADV_DONTNEED 0
+#endif
+
+static long fileLinesIndexed(const PagedFile *paged) {
+    return paged->page_first_line[paged->indexed_pages];
+}
+
+static size_t pageStart(long page) {
+    return (size_t) page * PAGED_PAGE_SIZE;
+}
+
+static size_t pageEnd(const PagedFile *paged, long page) {
+    size_t end = pageStart(page + 1);
+    return end < paged->size ? end : paged->size;
+}
+
+static void adviseRange(const PagedFile *paged, size_t start, size_t length, int advice) {
+#ifndef _WIN32
+    size_t aligned = start - start % (size_t) sysconf(_SC_PAGESIZE);
+    size_t end = start + length < paged->size ? start + length : paged->size;
+    if (aligned < end) {
+        madvise((void *) (paged->data + aligned), end - aligned, advice);
+    }
+#endif
+}
+
+static long countLineStarts(const PagedFile *paged, long page) {
+    size_t start = pageStart(page);
+    size_t end = pageEnd(paged, page);
+    long count = start == 0 ? 1 : paged->data[start - 1] == '\n';
+    const char *p = paged->data + start;
+    const char *last = paged->data + end - 1;
+
+    while (p < last && (p = memchr(p, '\n', last - p)) != nullptr) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+SDL_bool pagedIndexStep(PagedFile *paged, int pages) {
+    long before = fileLinesIndexed(paged);
+    while (pages-- > 0 && paged->indexed_pages < paged->page_count) {
+        long page = paged->indexed_pages;
+        adviseRange(paged, pageStart(page + 1), PAGED_PAGE_SIZE, MADV_WILLNEED);
+        paged->page_first_line[page + 1] = paged->page_first_line[page] + countLineStarts(paged, page);
+        paged->indexed_pages++;
+        if (paged->last_page != page) {
+            adviseRange(paged, pageStart(page), PAGED_PAGE_SIZE, MADV_DONTNEED);
+        }
+    }
+
+    long added = fileLinesIndexed(paged) - before;
+    if (added > 0 && paged->piece_count > 0 && paged->pieces[paged->piece_count - 1].open) {
+        paged->pieces[paged->piece_count - 1].count += added;
+        paged->line_count += added;
+    }
+    return paged->indexed_pages < paged->page_count;
+}
+
+void pagedEnsureLines(PagedFile *paged, long count) {
+    while (paged->line_count < count && pagedIndexStep(paged, 1)) {
+    }
+}
+
+long pagedLineCount(const PagedFile *paged) {
+    return paged->line_count;
+}
+
+static PageCacheEntry *decodePage(PagedFile *paged, long page) {
+    PageCacheEntry *slot = &paged->cache[0];
+    for (int i = 0; i < PAGED_CACHE_PAGES; i++) {
+        PageCacheEntry *entry = &paged->cache[i];
+        if (entry->offsets && entry->page == page) {
+            entry->last_used = ++paged->clock;
+            return entry;
+        }
+        if (entry->last_used < slot->last_used) {
+            slot = entry;
+        }
+    }
+
+    if (slot->offsets) {
+        adviseRange(paged, pageStart(slot->page), PAGED_PAGE_SIZE, MADV_DONTNEED);
+    }
+
+    int count = (int) (paged->page_first_line[page + 1] - paged->page_first_line[page]);
+    Uint32 *offsets = realloc(slot->offsets, (count ? count : 1) * sizeof(Uint32));
+    if (offsets == nullptr) {
+        return nullptr;
+    }
+
+    size_t start = pageStart(page);
+    size_t end = pageEnd(paged, page);
+    int n = 0;
+    if (start == 0 || paged->data[start - 1] == '\n') {
+        offsets[n++] = 0;
+    }
+    const char *p = paged->data + start;
+    const char *last = paged->data + end - 1;
+    while (p < last && (p = memchr(p, '\n', last - p)) != nullptr) {
+        offsets[n++] = (Uint32) (p + 1 - (paged->data + start));
+        p++;
+    }
+
+    slot->page = page;
+    slot->line_count = n;
+    slot->offsets = offsets;
+    slot->last_used = ++paged->clock;
+
+    if (page > paged->last_page) {
+        adviseRange(paged, pageStart(page + 1), PAGED_PAGE_SIZE, MADV_WILLNEED);
+    } else if (page < paged->last_page && page > 0) {
+        adviseRange(paged, pageStart(page - 1), PAGED_PAGE_SIZE, MADV_WILLNEED);
+    }
+    paged->last_page = page;
+    return slot;
+}
+
+static const char *fileLine(PagedFile *paged, long line, size_t *length) {
+    long low = 0;
+    long high = paged->indexed_pages - 1;
+    while (low < high) {
+        long mid = (low + high + 1) / 2;
+        if (paged->page_first_line[mid] <= line) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    PageCacheEntry *entry = decodePage(paged, low);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+
+    const char *start = paged->data + pageStart(low) + entry->offsets[line - paged->page_first_line[low]];
+    const char *end = memchr(start, '\n', paged->data + paged->size - start);
+    *length = (end ? end : paged->data + paged->size) - start;
+    return start;
+}
+
+static size_t fileLineOffset(PagedFile *paged, long line) {
+    size_t length;
+    if (line >= fileLinesIndexed(paged)) {
+        return paged->size;
+    }
+    const char *start = fileLine(paged, line, &length);
+    return start ? (size_t) (start - paged->data) : paged->size;
+}
+
+static int findPiece(const PagedFile *paged, long line, long *offset) {
+    for (int i = 0; i < paged->piece_count; i++) {
+        if (line < paged->pieces[i].count) {
+            *offset = line;
+            return i;
+        }
+        line -= paged->pieces[i].count;
+    }
+    *offset = 0;
+    return paged->piece_count;
+}
+
+int pagedGetLine(PagedFile *paged, long line, char *out) {
+    long offset;
+    int i = findPiece(paged, line, &offset);
+    if (i == paged->piece_count) {
+        out[0] = '\0';
+        return -1;
+    }
+
+    Piece *piece = &paged->pieces[i];
+    if (piece->source == PIECE_ADDED) {
+        strcpy(out, paged->added[piece->start + offset]);
+        return (int) strlen(out);
+    }
+
+    size_t length;
+    const char *text = fileLine(paged, piece->start + offset, &length);
+    if (text == nullptr) {
+        out[0] = '\0';
+        return -1;
+    }
+    size_t copy = length < MAX_LINE_LENGTH - 1 ? length : MAX_LINE_LENGTH - 1;
+    memcpy(out, text, copy);
+    out[copy] = '\0';
+    return length > SDL_MAX_SINT32 ? SDL_MAX_SINT32 : (int) length;
+}
+
+static int insertPiece(PagedFile *paged, int index, Piece piece) {
+    if (paged->piece_count == paged->piece_capacity) {
+        int capacity = paged->piece_capacity ? paged->piece_capacity * 2 : 16;
+        Piece *pieces = realloc(paged->pieces, capacity * sizeof(Piece));
+        if (pieces == nullptr) {
+            return -1;
+        }
+        paged->pieces = pieces;
+        paged->piece_capacity = capacity;
+    }
+
+    memmove(&paged->pieces[index + 1], &paged->pieces[index], (paged->piece_count - index) * sizeof(Piece));
+    paged->pieces[index] = piece;
+    paged->piece_count++;
+    return 0;
+}
+
+static void erasePiece(PagedFile *paged, int index) {
+    memmove(&paged->pieces[index], &paged->pieces[index + 1], (paged->piece_count - index - 1) * sizeof(Piece));
+    paged->piece_count--;
+}
+
+static int splitPieces(PagedFile *paged, long line) {
+    long offset;
+    int i = findPiece(paged, line, &offset);
+
+    if (i == paged->piece_count) {
+        if (i > 0 && paged->pieces[i - 1].open) {
+            Piece *last = &paged->pieces[i - 1];
+            if (last->count == 0) {
+                return i - 1;
+            }
+            Piece tail = {PIECE_FILE, SDL_TRUE, last->start + last->count, 0};
+            last->open = SDL_FALSE;
+            if (insertPiece(paged, i, tail) != 0) {
+                paged->pieces[i - 1].open = SDL_TRUE;
+                return -1;
+            }
+        }
+        return i;
+    }
+    if (offset == 0) {
+        return i;
+    }
+
+    Piece *piece = &paged->pieces[i];
+    Piece tail = {piece->source, piece->open, piece->start + offset, piece->count - offset};
+    if (insertPiece(paged, i + 1, tail) != 0) {
+        return -1;
+    }
+    paged->pieces[i].count = offset;
+    paged->pieces[i].open = SDL_FALSE;
+    return i + 1;
+}
+
+static long addLine(PagedFile *paged, const char *text) {
+    if (paged->added_count == paged->added_capacity) {
+        long capacity = paged->added_capacity ? paged->added_capacity * 2 : 64;
+        char **added = realloc(paged->added, capacity * sizeof(char *));
+        if (added == nullptr) {
+            return -1;
+        }
+        paged->added = added;
+        paged->added_capacity = capacity;
+    }
+
+    char *line = allocLine();
+    if (line == nullptr) {
+        return -1;
+    }
+    strncpy(line, text, MAX_LINE_LENGTH - 1);
+    paged->added[paged->added_count] = line;
+    return paged->added_count++;
+}
+
+int pagedSetLine(PagedFile *paged, long line, const char *text) {
+    long offset;
+    int i = findPiece(paged, line, &offset);
+    if (i == paged->piece_count) {
+        return -1;
+    }
+
+    paged->modified = SDL_TRUE;
+    if (paged->pieces[i].source == PIECE_ADDED) {
+        strncpy(paged->added[paged->pieces[i].start + offset], text, MAX_LINE_LENGTH - 1);
+        return 0;
+    }
+
+    long added = addLine(paged, text);
+    if (added < 0 || splitPieces(paged, line + 1) < 0) {
+        return -1;
+    }
+    i = splitPieces(paged, line);
+    if (i < 0) {
+        return -1;
+    }
+    paged->pieces[i] = (Piece) {PIECE_ADDED, SDL_FALSE, added, 1};
+    return 0;
+}
+
+int pagedInsertLine(PagedFile *paged, long index, const char *text) {
+    long added = addLine(paged, text);
+    int i = added < 0 ? -1 : splitPieces(paged, index);
+    if (i < 0 || insertPiece(paged, i, (Piece) {PIECE_ADDED, SDL_FALSE, added, 1}) != 0) {
+        return -1;
+    }
+    paged->line_count++;
+    paged->modified = SDL_TRUE;
+    return 0;
+}
+
+int pagedRemoveLine(PagedFile *paged, long index) {
+    if (index < 0 || index >= paged->line_count || splitPieces(paged, index + 1) < 0) {
+        return -1;
+    }
+    int i = splitPieces(paged, index);
+    if (i < 0) {
+        return -1;
+    }
+    erasePiece(paged, i);
+    paged->line_count--;
+    paged->modified = SDL_TRUE;
+    return 0;
+}
+
+#ifndef _WIN32
+
+SDL_bool pagedWanted(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= PAGED_MODE_THRESHOLD;
+}
+
+int pagedOpen(PagedFile *paged, const char *path) {
+    memset(paged, 0, sizeof(*paged));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Error: Could not open file for reading.\n");
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        printf("Error: Could not map %s.\n", path);
+        return 1;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Error: Could not map %s.\n", path);
+        return 1;
+    }
+
+    paged->data = data;
+    paged->size = st.st_size;
+    paged->page_count = (long) ((paged->size + PAGED_PAGE_SIZE - 1) / PAGED_PAGE_SIZE);
+    paged->page_first_line = calloc(paged->page_count + 1, sizeof(long));
+    paged->path = strdup(path);
+    if (paged->page_first_line == nullptr || paged->path == nullptr ||
+        insertPiece(paged, 0, (Piece) {PIECE_FILE, SDL_TRUE, 0, 0}) != 0) {
+        pagedClose(paged);
+        return 1;
+    }
+
+    madvise(data, paged->size, MADV_SEQUENTIAL);
+    pagedEnsureLines(paged, 1);
+    printf("Opened %s in paged mode (%zu bytes).\n", path, paged->size);
+    return 0;
+}
+
+void pagedClose(PagedFile *paged) {
+    if (paged->data) {
+        munmap((void *) paged->data, paged->size);
+    }
+    for (int i = 0; i < PAGED_CACHE_PAGES; i++) {
+        free(paged->cache[i].offsets);
+    }
+    for (long i = 0; i < paged->added_count; i++) {
+        freeLine(paged->added[i]);
+    }
+    free(paged->added);
+    free(paged->pieces);
+    free(paged->page_first_line);
+    free(paged->path);
+    memset(paged, 0, sizeof(*paged));
+}
+
+static int writePieces(PagedFile *paged, FILE *file) {
+    for (int i = 0; i < paged->piece_count; i++) {
+        Piece *piece = &paged->pieces[i];
+        if (piece->source == PIECE_ADDED) {
+            for (long j = 0; j < piece->count; j++) {
+                fprintf(file, "%s\n", paged->added[piece->start + j]);
+            }
+        } else if (piece->count > 0) {
+            size_t start = fileLineOffset(paged, piece->start);
+            size_t end = fileLineOffset(paged, piece->start + piece->count);
+            fwrite(paged->data + start, 1, end - start, file);
+            if (end == paged->size && paged->data[end - 1] != '\n') {
+                fputc('\n', file);
+            }
+        }
+    }
+    return ferror(file) ? -1 : 0;
+}
+
+int pagedSave(PagedFile *paged, const char *path) {
+    while (pagedIndexStep(paged, 64)) {
+    }
+
+    struct stat target, source;
+    SDL_bool in_place = stat(path, &target) == 0 && stat(paged->path, &source) == 0 &&
+                        target.st_dev == source.st_dev && target.st_ino == source.st_ino;
+
+    size_t length = strlen(path);
+    char *temp_path = malloc(length + 5);
+    if (temp_path == nullptr) {
+        return -1;
+    }
+    snprintf(temp_path, length + 5, "%s.tmp", path);
+
+    FILE *file = fopen(in_place ? temp_path : path, "w");
+    if (file == nullptr) {
+        printf("Error: Could not open file for writing.\n");
+        free(temp_path);
+        return -1;
+    }
+
+    madvise((void *) paged->data, paged->size, MADV_SEQUENTIAL);
+    int result = writePieces(paged, file);
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+
+    if (result == 0 && in_place) {
+        if (rename(temp_path, path) != 0) {
+            result = -1;
+        } else {
+            char *reopen = strdup(path);
+            pagedClose(paged);
+            if (reopen == nullptr || pagedOpen(paged, reopen) != 0) {
+                result = -1;
+            }
+            free(reopen);
+        }
+    } else if (in_place) {
+        remove(temp_path);
+    }
+
+    if (result != 0) {
+        printf("Error: Could not save %s.\n", path);
+    } else {
+        paged->modified = SDL_FALSE;
+    }
+    free(temp_path);
+    return result;
+}
+
+#else
+
+SDL_bool pagedWanted(const char *path) {
+    return SDL_FALSE;
+}
+
+int pagedOpen(PagedFile *paged, const char *path) {
+    memset(paged, 0, sizeof(*paged));
+    printf("Error: Paged mode is not supported on this platform.\n");
+    return 1;
+}
+
+void pagedClose(PagedFile *paged) {
+    memset(paged, 0, sizeof(*paged));
+}
+
+int pagedSave(PagedFile *paged, const char *path) {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef TEXTEDITOR_PAGED_H
+#define TEXTEDITOR_PAGED_H
+
+#include <SDL.h>
+#include <stddef.h>
+#include "document.h"
+
+#define PAGED_PAGE_SIZE (1 << 20)
+#define PAGED_CACHE_PAGES 32
+#define PAGED_INDEX_STEP 4
+#define PAGED_MODE_THRESHOLD (256LL << 20)
+
+typedef struct {
+    long page;
+    int line_count;
+    Uint32 *offsets;
+    Uint64 last_used;
+} PageCacheEntry;
+
+enum {
+    PIECE_FILE,
+    PIECE_ADDED
+};
+
+typedef struct {
+    int source;
+    SDL_bool open;
+    long start;
+    long count;
+} Piece;
+
+typedef struct {
+    char *path;
+    const char *data;
+    size_t size;
+    long page_count;
+    long indexed_pages;
+    long *page_first_line;
+    PageCacheEntry cache[PAGED_CACHE_PAGES];
+    Uint64 clock;
+    long last_page;
+    Piece *pieces;
+    int piece_count;
+    int piece_capacity;
+    char **added;
+    long added_count;
+    long added_capacity;
+    long line_count;
+    SDL_bool modified;
+} PagedFile;
+
+SDL_bool pagedWanted(const char *path);
+
+int pagedOpen(PagedFile *paged, const char *path);
+
+void pagedClose(PagedFile *paged);
+
+SDL_bool pagedIndexStep(PagedFile *paged, int pages);
+
+void pagedEnsureLines(PagedFile *paged, long count);
+
+long pagedLineCount(const PagedFile *paged);
+
+int pagedGetLine(PagedFile *paged, long line, char *out);
+
+int pagedSetLine(PagedFile *paged, long line, const char *text);
+
+int pagedInsertLine(PagedFile *paged, long index, const char *text);
+
+int pagedRemoveLine(PagedFile *paged, long index);
+
+int pagedSave(PagedFile *paged, const char *path);
+
+#endif
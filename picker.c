@@ -0,0 +1,433 @@
+#include "picker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+
+typedef struct {
+    Uint64 d_ino;
+    Sint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+} LinuxDirent;
+#endif
+
+static void freeEntries(PickerEntry *entries, int count) {
+    for (int i = 0; i < count; i++) {
+        free(entries[i].name);
+    }
+    free(entries);
+}
+
+static void freeListing(DirListing *listing) {
+    freeEntries(listing->entries, listing->count);
+    free(listing->path);
+    *listing = (DirListing) {0};
+}
+
+static int addEntry(PickerEntry **entries, int *count, int *capacity, const char *name, SDL_bool directory) {
+    if (*count == *capacity) {
+        int grown_capacity = *capacity ? *capacity * 2 : 64;
+        PickerEntry *grown = realloc(*entries, grown_capacity * sizeof(PickerEntry));
+        if (grown == nullptr) {
+            return -1;
+        }
+        *entries = grown;
+        *capacity = grown_capacity;
+    }
+    char *copy = strdup(name);
+    if (copy == nullptr) {
+        return -1;
+    }
+    (*entries)[(*count)++] = (PickerEntry) {copy, directory};
+    return 0;
+}
+
+static int readDirStamp(const char *path, long long *mtime) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return -1;
+    }
+#if defined(__linux__)
+    *mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    *mtime = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    *mtime = st.st_mtime * 1000000000LL;
+#endif
+    return 0;
+}
+
+#ifndef _WIN32
+static SDL_bool directoryAt(int dir_fd, const char *name, unsigned char type) {
+    struct stat st;
+    if (type != DT_LNK && type != DT_UNKNOWN) {
+        return type == DT_DIR;
+    }
+    return fstatat(dir_fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+}
+
+static SDL_bool skipName(const char *name) {
+    return strcmp(name, ".") == 0 || strcmp(name, "..") == 0;
+}
+#endif
+
+#if defined(__linux__)
+static int scanEntries(const char *path, PickerEntry **entries, int *count) {
+    int capacity = 0;
+    *entries = nullptr;
+    *count = 0;
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char *buffer = malloc(PICKER_SCAN_BUFFER);
+    int result = buffer ? 0 : -1;
+    long read = 0;
+    while (result == 0 && (read = syscall(SYS_getdents64, fd, buffer, PICKER_SCAN_BUFFER)) > 0) {
+        for (long pos = 0; pos < read && result == 0;) {
+            LinuxDirent *entry = (LinuxDirent *) (buffer + pos);
+            pos += entry->d_reclen;
+            if (!skipName(entry->d_name)) {
+                result = addEntry(entries, count, &capacity, entry->d_name,
+                                  directoryAt(fd, entry->d_name, entry->d_type));
+            }
+        }
+    }
+    free(buffer);
+    close(fd);
+    if (result != 0 || read < 0) {
+        freeEntries(*entries, *count);
+        *entries = nullptr;
+        *count = 0;
+        return -1;
+    }
+    return 0;
+}
+#elif !defined(_WIN32)
+static int scanEntries(const char *path, PickerEntry **entries, int *count) {
+    int capacity = 0;
+    *entries = nullptr;
+    *count = 0;
+    DIR *dir = opendir(path);
+    if (dir == nullptr) {
+        return -1;
+    }
+
+    int result = 0;
+    struct dirent *entry;
+    while (result == 0 && (entry = readdir(dir)) != nullptr) {
+        if (!skipName(entry->d_name)) {
+            result = addEntry(entries, count, &capacity, entry->d_name,
+                              directoryAt(dirfd(dir), entry->d_name, entry->d_type));
+        }
+    }
+    closedir(dir);
+    if (result != 0) {
+        freeEntries(*entries, *count);
+        *entries = nullptr;
+        *count = 0;
+    }
+    return result;
+}
+#else
+static int scanEntries(const char *path, PickerEntry **entries, int *count) {
+    *entries = nullptr;
+    *count = 0;
+    return -1;
+}
+#endif
+
+static int compareEntries(const void *a, const void *b) {
+    const PickerEntry *x = a;
+    const PickerEntry *y = b;
+    if (x->directory != y->directory) {
+        return x->directory ? -1 : 1;
+    }
+    return SDL_strcasecmp(x->name, y->name);
+}
+
+static DirListing *loadListing(FilePicker *picker, const char *path) {
+    long long mtime;
+    if (readDirStamp(path, &mtime) != 0) {
+        return nullptr;
+    }
+
+    DirListing *slot = &picker->cache[0];
+    for (int i = 0; i < PICKER_CACHE_SIZE; i++) {
+        DirListing *listing = &picker->cache[i];
+        if (listing->path && strcmp(listing->path, path) == 0) {
+            if (listing->mtime == mtime) {
+                listing->used = ++picker->clock;
+                return listing;
+            }
+            slot = listing;
+            break;
+        }
+        if (listing->used < slot->used) {
+            slot = listing;
+        }
+    }
+
+    PickerEntry *entries;
+    int count;
+    if (scanEntries(path, &entries, &count) != 0) {
+        return nullptr;
+    }
+    char *copy = strdup(path);
+    if (copy == nullptr) {
+        freeEntries(entries, count);
+        return nullptr;
+    }
+    qsort(entries, count, sizeof(PickerEntry), compareEntries);
+    freeListing(slot);
+    *slot = (DirListing) {copy, mtime, entries, count, ++picker->clock};
+    return slot;
+}
+
+static int fuzzyScore(const char *name, const char *query) {
+    int score = 0;
+    int last = -2;
+    int i = 0;
+    for (const char *q = query; *q; q++) {
+        int c = SDL_tolower((unsigned char) *q);
+        while (name[i] && SDL_tolower((unsigned char) name[i]) != c) {
+            i++;
+        }
+        if (name[i] == '\0') {
+            return -1;
+        }
+        score += 1;
+        if (i == last + 1) {
+            score += 4;
+        }
+        if (i == 0 || strchr("._- ", name[i - 1])) {
+            score += 6;
+        }
+        last = i++;
+    }
+    int length = strlen(name);
+    return score * 256 - (length < 255 ? length : 255);
+}
+
+static int compareMatches(const void *a, const void *b) {
+    const PickerMatch *x = a;
+    const PickerMatch *y = b;
+    if (x->score != y->score) {
+        return y->score - x->score;
+    }
+    return x->entry - y->entry;
+}
+
+static void filterEntries(FilePicker *picker, SDL_bool narrow) {
+    DirListing *listing = picker->listing;
+    picker->selected = 0;
+    picker->first_row = 0;
+    if (!narrow) {
+        if (listing->count > picker->match_capacity) {
+            PickerMatch *matches = realloc(picker->matches, listing->count * sizeof(PickerMatch));
+            if (matches == nullptr) {
+                picker->match_count = 0;
+                return;
+            }
+            picker->matches = matches;
+            picker->match_capacity = listing->count;
+        }
+        for (int i = 0; i < listing->count; i++) {
+            picker->matches[i] = (PickerMatch) {i, 0};
+        }
+        picker->match_count = listing->count;
+    }
+
+    SDL_bool hidden = picker->query[0] == '.';
+    int kept = 0;
+    for (int i = 0; i < picker->match_count; i++) {
+        int entry = picker->matches[i].entry;
+        const char *name = listing->entries[entry].name;
+        if (name[0] == '.' && !hidden) {
+            continue;
+        }
+        int score = picker->query_length > 0 ? fuzzyScore(name, picker->query) : 0;
+        if (score >= 0) {
+            picker->matches[kept++] = (PickerMatch) {entry, score};
+        }
+    }
+    picker->match_count = kept;
+    if (picker->query_length > 0) {
+        qsort(picker->matches, picker->match_count, sizeof(PickerMatch), compareMatches);
+    }
+}
+
+static char *joinPath(const char *dir, const char *name) {
+    size_t length = strlen(dir) + strlen(name) + 2;
+    char *path = malloc(length);
+    if (path) {
+        snprintf(path, length, strcmp(dir, "/") == 0 ? "%s%s" : "%s/%s", dir, name);
+    }
+    return path;
+}
+
+static int enterDirectory(FilePicker *picker, const char *path, const char *select) {
+    DirListing *listing = loadListing(picker, path);
+    char *dir = listing ? strdup(path) : nullptr;
+    if (dir == nullptr) {
+        printf("Picker Error: could not read %s\n", path);
+        return -1;
+    }
+    free(picker->dir);
+    picker->dir = dir;
+    picker->listing = listing;
+    picker->query[0] = '\0';
+    picker->query_length = 0;
+    filterEntries(picker, SDL_FALSE);
+
+    for (int i = 0; select && i < picker->match_count; i++) {
+        if (strcmp(listing->entries[picker->matches[i].entry].name, select) == 0) {
+            picker->selected = i;
+            break;
+        }
+    }
+    return 0;
+}
+
+static void enterParent(FilePicker *picker) {
+    char *slash = strrchr(picker->dir, '/');
+    if (slash == nullptr || picker->dir[1] == '\0') {
+        return;
+    }
+    int length = slash == picker->dir ? 1 : slash - picker->dir;
+    char *parent = malloc(length + 1);
+    char *child = strdup(slash + 1);
+    if (parent && child) {
+        memcpy(parent, picker->dir, length);
+        parent[length] = '\0';
+        enterDirectory(picker, parent, child);
+    }
+    free(parent);
+    free(child);
+}
+
+void initPicker(FilePicker *picker) {
+    memset(picker, 0, sizeof(*picker));
+}
+
+void freePicker(FilePicker *picker) {
+    for (int i = 0; i < PICKER_CACHE_SIZE; i++) {
+        freeListing(&picker->cache[i]);
+    }
+    free(picker->dir);
+    free(picker->matches);
+    memset(picker, 0, sizeof(*picker));
+}
+
+int openPicker(FilePicker *picker, const char *file) {
+#ifdef _WIN32
+    return -1;
+#else
+    char resolved[PATH_MAX];
+    const char *dir = resolved;
+    if (file && realpath(file, resolved)) {
+        char *slash = strrchr(resolved, '/');
+        slash[slash == resolved ? 1 : 0] = '\0';
+    } else if (picker->dir) {
+        dir = picker->dir;
+    } else if (getcwd(resolved, sizeof(resolved)) == nullptr) {
+        return -1;
+    }
+    if (enterDirectory(picker, dir, nullptr) != 0) {
+        return -1;
+    }
+    picker->active = SDL_TRUE;
+    return 0;
+#endif
+}
+
+void closePicker(FilePicker *picker) {
+    picker->active = SDL_FALSE;
+}
+
+void pickerType(FilePicker *picker, const char *text) {
+    int length = strlen(text);
+    if (picker->listing == nullptr || picker->query_length + length >= PICKER_QUERY_LENGTH) {
+        return;
+    }
+    SDL_bool narrow = picker->query_length > 0;
+    memcpy(picker->query + picker->query_length, text, length + 1);
+    picker->query_length += length;
+    filterEntries(picker, narrow);
+}
+
+char *pickerKey(FilePicker *picker, SDL_Keycode key) {
+    switch (key) {
+        case SDLK_ESCAPE:
+            closePicker(picker);
+            break;
+
+        case SDLK_UP:
+            if (picker->selected > 0) {
+                picker->selected--;
+            }
+            break;
+
+        case SDLK_DOWN:
+            if (picker->selected + 1 < picker->match_count) {
+                picker->selected++;
+            }
+            break;
+
+        case SDLK_PAGEUP:
+            picker->selected = picker->selected > PICKER_PAGE_ROWS ? picker->selected - PICKER_PAGE_ROWS : 0;
+            break;
+
+        case SDLK_PAGEDOWN:
+            picker->selected += PICKER_PAGE_ROWS;
+            if (picker->selected >= picker->match_count) {
+                picker->selected = picker->match_count > 0 ? picker->match_count - 1 : 0;
+            }
+            break;
+
+        case SDLK_BACKSPACE:
+            if (picker->query_length > 0) {
+                do {
+                    picker->query_length--;
+                } while (picker->query_length > 0 && (picker->query[picker->query_length] & 0xC0) == 0x80);
+                picker->query[picker->query_length] = '\0';
+                filterEntries(picker, SDL_FALSE);
+            } else {
+                enterParent(picker);
+            }
+            break;
+
+        case SDLK_RETURN: {
+            if (picker->match_count == 0) {
+                break;
+            }
+            const PickerEntry *entry = &picker->listing->entries[picker->matches[picker->selected].entry];
+            SDL_bool directory = entry->directory;
+            char *path = joinPath(picker->dir, entry->name);
+            if (path == nullptr) {
+                break;
+            }
+            if (directory) {
+                enterDirectory(picker, path, nullptr);
+                free(path);
+                break;
+            }
+            closePicker(picker);
+            return path;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,56 @@
+#ifndef TEXTEDITOR_PICKER_H
+#define TEXTEDITOR_PICKER_H
+
+#include <SDL.h>
+
+#define PICKER_CACHE_SIZE 16
+#define PICKER_QUERY_LENGTH 256
+#define PICKER_SCAN_BUFFER 32768
+#define PICKER_PAGE_ROWS 10
+
+typedef struct {
+    char *name;
+    SDL_bool directory;
+} PickerEntry;
+
+typedef struct {
+    char *path;
+    long long mtime;
+    PickerEntry *entries;
+    int count;
+    Uint64 used;
+} DirListing;
+
+typedef struct {
+    int entry;
+    int score;
+} PickerMatch;
+
+typedef struct {
+    SDL_bool active;
+    char *dir;
+    DirListing cache[PICKER_CACHE_SIZE];
+    Uint64 clock;
+    DirListing *listing;
+    char query[PICKER_QUERY_LENGTH];
+    int query_length;
+    PickerMatch *matches;
+    int match_count;
+    int match_capacity;
+    int selected;
+    int first_row;
+} FilePicker;
+
+void initPicker(FilePicker *picker);
+
+void freePicker(FilePicker *picker);
+
+int openPicker(FilePicker *picker, const char *file);
+
+void closePicker(FilePicker *picker);
+
+void pickerType(FilePicker *picker, const char *text);
+
+char *pickerKey(FilePicker *picker, SDL_Keycode key);
+
+#endif
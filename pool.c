@@ -0,0 +1,87 @@
+#include "pool.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+int poolInit(Pool *pool, size_t node_size) {
+    int line_size = SDL_GetCPUCacheLineSize();
+    pool->alignment = line_size > 0 ? (size_t) line_size : 64;
+    if (node_size < sizeof(PoolNode)) {
+        node_size = sizeof(PoolNode);
+    }
+    pool->node_size = (node_size + pool->alignment - 1) / pool->alignment * pool->alignment;
+    pool->nodes_per_slab = (POOL_SLAB_SIZE - sizeof(PoolSlab)) / pool->node_size;
+    pool->free_list = nullptr;
+    pool->slabs = nullptr;
+    pool->lock = 0;
+    pool->live = 0;
+    pool->slab_count = 0;
+    return pool->nodes_per_slab > 0 ? 0 : -1;
+}
+
+static int growPool(Pool *pool) {
+    void *memory = malloc(POOL_SLAB_SIZE + pool->alignment);
+    if (memory == nullptr) {
+        return -1;
+    }
+
+    uintptr_t aligned = ((uintptr_t) memory + pool->alignment - 1) & ~(uintptr_t) (pool->alignment - 1);
+    PoolSlab *slab = (PoolSlab *) (aligned + pool->nodes_per_slab * pool->node_size);
+    slab->memory = memory;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count++;
+
+    for (size_t i = pool->nodes_per_slab; i-- > 0;) {
+        PoolNode *node = (PoolNode *) (aligned + i * pool->node_size);
+        node->next = pool->free_list;
+        pool->free_list = node;
+    }
+    return 0;
+}
+
+void *poolAlloc(Pool *pool) {
+    void *node = nullptr;
+    poolAllocMany(pool, &node, 1);
+    return node;
+}
+
+int poolAllocMany(Pool *pool, void **nodes, int count) {
+    int allocated = 0;
+    SDL_AtomicLock(&pool->lock);
+    while (allocated < count) {
+        if (pool->free_list == nullptr && growPool(pool) != 0) {
+            break;
+        }
+        PoolNode *node = pool->free_list;
+        pool->free_list = node->next;
+        nodes[allocated++] = node;
+    }
+    pool->live += allocated;
+    SDL_AtomicUnlock(&pool->lock);
+    return allocated;
+}
+
+void poolFree(Pool *pool, void *node) {
+    if (node == nullptr) {
+        return;
+    }
+    SDL_AtomicLock(&pool->lock);
+    PoolNode *free_node = node;
+    free_node->next = pool->free_list;
+    pool->free_list = free_node;
+    pool->live--;
+    SDL_AtomicUnlock(&pool->lock);
+}
+
+void poolDestroy(Pool *pool) {
+    PoolSlab *slab = pool->slabs;
+    while (slab) {
+        PoolSlab *next = slab->next;
+        free(slab->memory);
+        slab = next;
+    }
+    pool->slabs = nullptr;
+    pool->free_list = nullptr;
+    pool->live = 0;
+    pool->slab_count = 0;
+}
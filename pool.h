@@ -0,0 +1,39 @@
+#ifndef TEXTEDITOR_POOL_H
+#define TEXTEDITOR_POOL_H
+
+#include <SDL.h>
+#include <stddef.h>
+
+#define POOL_SLAB_SIZE (64 * 1024)
+
+typedef struct PoolSlab {
+    struct PoolSlab *next;
+    void *memory;
+} PoolSlab;
+
+typedef struct PoolNode {
+    struct PoolNode *next;
+} PoolNode;
+
+typedef struct {
+    size_t node_size;
+    size_t nodes_per_slab;
+    size_t alignment;
+    PoolNode *free_list;
+    PoolSlab *slabs;
+    SDL_SpinLock lock;
+    size_t live;
+    size_t slab_count;
+} Pool;
+
+int poolInit(Pool *pool, size_t node_size);
+
+void *poolAlloc(Pool *pool);
+
+int poolAllocMany(Pool *pool, void **nodes, int count);
+
+void poolFree(Pool *pool, void *node);
+
+void poolDestroy(Pool *pool);
+
+#endif
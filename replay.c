@@ -0,0 +1,278 @@
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "TERC"
+#define REPLAY_VERSION 2
+#define REPLAY_WHEEL_SCALE 1000.0
+
+enum {
+    REC_KEY = 1,
+    REC_TEXT = 2,
+    REC_WHEEL = 3,
+    REC_RESIZE = 4,
+    REC_QUIT = 5
+};
+
+static void writeVarint(FILE *file, Uint64 value) {
+    do {
+        Uint8 byte = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        fputc(byte, file);
+    } while (value);
+}
+
+static int readVarint(FILE *file, Uint64 *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = fgetc(file);
+        if (byte == EOF) {
+            return -1;
+        }
+        *value |= (Uint64) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static Uint64 zigzag(Sint64 value) {
+    return ((Uint64) value << 1) ^ (Uint64) (value >> 63);
+}
+
+static Sint64 unzigzag(Uint64 value) {
+    return (Sint64) (value >> 1) ^ -(Sint64) (value & 1);
+}
+
+static void writeRecordHeader(Recorder *recorder, int type, Uint32 timestamp) {
+    Uint32 delta = timestamp >= recorder->last_timestamp ? timestamp - recorder->last_timestamp : 0;
+    recorder->last_timestamp = timestamp;
+    fputc(type, recorder->file);
+    writeVarint(recorder->file, delta);
+}
+
+int recorderOpen(Recorder *recorder, const char *path, int window_width, int window_height) {
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL) {
+        printf("Error: Could not open %s for recording.\n", path);
+        return 1;
+    }
+
+    fwrite(REPLAY_MAGIC, 1, 4, recorder->file);
+    fputc(REPLAY_VERSION, recorder->file);
+    writeVarint(recorder->file, window_width);
+    writeVarint(recorder->file, window_height);
+    recorder->last_timestamp = SDL_GetTicks();
+    recorder->last_width = window_width;
+    recorder->last_height = window_height;
+    return 0;
+}
+
+void recordEvent(Recorder *recorder, const SDL_Event *event, SDL_Keymod mod, int window_width, int window_height) {
+    if (recorder->file == NULL) {
+        return;
+    }
+
+    if (window_width != recorder->last_width || window_height != recorder->last_height) {
+        writeRecordHeader(recorder, REC_RESIZE, event->common.timestamp);
+        writeVarint(recorder->file, window_width);
+        writeVarint(recorder->file, window_height);
+        recorder->last_width = window_width;
+        recorder->last_height = window_height;
+    }
+
+    switch (event->type) {
+        case SDL_KEYDOWN:
+            writeRecordHeader(recorder, REC_KEY, event->key.timestamp);
+            writeVarint(recorder->file, (Uint32) event->key.keysym.sym);
+            writeVarint(recorder->file, mod);
+            break;
+
+        case SDL_TEXTINPUT: {
+            size_t len = strnlen(event->text.text, sizeof(event->text.text) - 1);
+            writeRecordHeader(recorder, REC_TEXT, event->text.timestamp);
+            fputc((int) len, recorder->file);
+            fwrite(event->text.text, 1, len, recorder->file);
+            break;
+        }
+
+        case SDL_MOUSEWHEEL:
+            writeRecordHeader(recorder, REC_WHEEL, event->wheel.timestamp);
+            writeVarint(recorder->file, zigzag(event->wheel.y));
+            writeVarint(recorder->file, zigzag((Sint64) SDL_lround(event->wheel.preciseY * REPLAY_WHEEL_SCALE)));
+            break;
+
+        case SDL_QUIT:
+            writeRecordHeader(recorder, REC_QUIT, event->common.timestamp);
+            break;
+    }
+}
+
+void recorderClose(Recorder *recorder) {
+    if (recorder->file) {
+        fclose(recorder->file);
+        recorder->file = NULL;
+    }
+}
+
+int replayerOpen(Replayer *replayer, const char *path, int *window_width, int *window_height) {
+    memset(replayer, 0, sizeof(*replayer));
+    replayer->file = fopen(path, "rb");
+    if (replayer->file == NULL) {
+        printf("Error: Could not open %s for replay.\n", path);
+        return 1;
+    }
+
+    char magic[4];
+    Uint64 width, height;
+    if (fread(magic, 1, 4, replayer->file) != 4 || memcmp(magic, REPLAY_MAGIC, 4) != 0 ||
+        fgetc(replayer->file) != REPLAY_VERSION ||
+        readVarint(replayer->file, &width) != 0 || readVarint(replayer->file, &height) != 0) {
+        printf("Error: %s is not a recording.\n", path);
+        fclose(replayer->file);
+        replayer->file = NULL;
+        return 1;
+    }
+
+    *window_width = (int) width;
+    *window_height = (int) height;
+    return 0;
+}
+
+static SDL_bool pushQuit(Replayer *replayer) {
+    SDL_Event event = {0};
+    event.type = SDL_QUIT;
+    SDL_PushEvent(&event);
+    fclose(replayer->file);
+    replayer->file = NULL;
+    return SDL_FALSE;
+}
+
+SDL_bool replayPump(Replayer *replayer, SDL_Window *window) {
+    if (replayer->file == NULL) {
+        return SDL_FALSE;
+    }
+    if (replayer->start == 0) {
+        replayer->start = SDL_GetPerformanceCounter();
+    }
+
+    int type = fgetc(replayer->file);
+    Uint64 delta, a, b;
+    if (type == EOF || readVarint(replayer->file, &delta) != 0) {
+        return pushQuit(replayer);
+    }
+    replayer->recorded_ms += (Uint32) delta;
+
+    SDL_Event event = {0};
+    switch (type) {
+        case REC_KEY:
+            if (readVarint(replayer->file, &a) != 0 || readVarint(replayer->file, &b) != 0) {
+                return pushQuit(replayer);
+            }
+            SDL_SetModState((SDL_Keymod) b);
+            event.type = SDL_KEYDOWN;
+            event.key.keysym.sym = (SDL_Keycode) a;
+            event.key.keysym.mod = (Uint16) b;
+            break;
+
+        case REC_TEXT: {
+            int len = fgetc(replayer->file);
+            if (len == EOF || len >= (int) sizeof(event.text.text) ||
+                fread(event.text.text, 1, len, replayer->file) != (size_t) len) {
+                return pushQuit(replayer);
+            }
+            event.type = SDL_TEXTINPUT;
+            break;
+        }
+
+        case REC_WHEEL:
+            if (readVarint(replayer->file, &a) != 0 || readVarint(replayer->file, &b) != 0) {
+                return pushQuit(replayer);
+            }
+            event.type = SDL_MOUSEWHEEL;
+            event.wheel.y = (Sint32) unzigzag(a);
+            event.wheel.preciseY = (float) (unzigzag(b) / REPLAY_WHEEL_SCALE);
+            break;
+
+        case REC_RESIZE:
+            if (readVarint(replayer->file, &a) != 0 || readVarint(replayer->file, &b) != 0) {
+                return pushQuit(replayer);
+            }
+            SDL_SetWindowSize(window, (int) a, (int) b);
+            event.type = SDL_WINDOWEVENT;
+            event.window.event = SDL_WINDOWEVENT_SIZE_CHANGED;
+            event.window.data1 = (Sint32) a;
+            event.window.data2 = (Sint32) b;
+            break;
+
+        case REC_QUIT:
+            return pushQuit(replayer);
+
+        default:
+            printf("Replay Error: unknown record type %d\n", type);
+            return pushQuit(replayer);
+    }
+
+    replayer->events++;
+    replayer->frame_start = SDL_GetPerformanceCounter();
+    replayer->pending_frame = SDL_TRUE;
+    SDL_PushEvent(&event);
+    return SDL_TRUE;
+}
+
+void replayFrameDone(Replayer *replayer) {
+    if (!replayer->pending_frame) {
+        return;
+    }
+    replayer->pending_frame = SDL_FALSE;
+
+    if (replayer->frame_count == replayer->frame_capacity) {
+        int capacity = replayer->frame_capacity ? replayer->frame_capacity * 2 : 1024;
+        Uint64 *frame_times = realloc(replayer->frame_times, capacity * sizeof(Uint64));
+        if (frame_times == NULL) {
+            return;
+        }
+        replayer->frame_times = frame_times;
+        replayer->frame_capacity = capacity;
+    }
+    replayer->frame_times[replayer->frame_count++] = SDL_GetPerformanceCounter() - replayer->frame_start;
+}
+
+static int compareTicks(const void *a, const void *b) {
+    Uint64 x = *(const Uint64 *) a;
+    Uint64 y = *(const Uint64 *) b;
+    return (x > y) - (x < y);
+}
+
+void replayerClose(Replayer *replayer) {
+    double freq = (double) SDL_GetPerformanceFrequency();
+    double total_ms = (SDL_GetPerformanceCounter() - replayer->start) * 1000.0 / freq;
+
+    printf("Replay: %d events, recorded %.3f s, replayed in %.3f ms\n",
+           replayer->events, replayer->recorded_ms / 1000.0, total_ms);
+
+    if (replayer->frame_count > 0) {
+        qsort(replayer->frame_times, replayer->frame_count, sizeof(Uint64), compareTicks);
+        Uint64 sum = 0;
+        for (int i = 0; i < replayer->frame_count; i++) {
+            sum += replayer->frame_times[i];
+        }
+        int count = replayer->frame_count;
+        printf("Frames: %d, mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", count,
+               sum * 1000.0 / freq / count,
+               replayer->frame_times[count / 2] * 1000.0 / freq,
+               replayer->frame_times[(count * 99) / 100] * 1000.0 / freq,
+               replayer->frame_times[count - 1] * 1000.0 / freq);
+    }
+
+    if (replayer->file) {
+        fclose(replayer->file);
+    }
+    free(replayer->frame_times);
+    memset(replayer, 0, sizeof(*replayer));
+}
@@ -0,0 +1,42 @@
+#ifndef TEXTEDITOR_REPLAY_H
+#define TEXTEDITOR_REPLAY_H
+
+#include <SDL.h>
+#include <stdio.h>
+
+#define REPLAY_VIDEO_DRIVER "dummy"
+
+typedef struct {
+    FILE *file;
+    Uint32 last_timestamp;
+    int last_width;
+    int last_height;
+} Recorder;
+
+typedef struct {
+    FILE *file;
+    Uint32 recorded_ms;
+    int events;
+    Uint64 start;
+    Uint64 frame_start;
+    Uint64 *frame_times;
+    int frame_count;
+    int frame_capacity;
+    SDL_bool pending_frame;
+} Replayer;
+
+int recorderOpen(Recorder *recorder, const char *path, int window_width, int window_height);
+
+void recordEvent(Recorder *recorder, const SDL_Event *event, SDL_Keymod mod, int window_width, int window_height);
+
+void recorderClose(Recorder *recorder);
+
+int replayerOpen(Replayer *replayer, const char *path, int *window_width, int *window_height);
+
+SDL_bool replayPump(Replayer *replayer, SDL_Window *window);
+
+void replayFrameDone(Replayer *replayer);
+
+void replayerClose(Replayer *replayer);
+
+#endif
@@ -0,0 +1,206 @@
+#include "scroll.h"
+#include <stdio.h>
+
+static Uint32 scrollFrame(Uint32 interval, void *param) {
+    (void) interval;
+    SmoothScroll *scroll = param;
+    SDL_Event event = {0};
+    event.type = scroll->event_type;
+    SDL_PushEvent(&event);
+    return 0;
+}
+
+static SDL_bool armFrame(SmoothScroll *scroll) {
+    if (scroll->timer == 0) {
+        scroll->timer = SDL_AddTimer(SCROLL_FRAME_MS, scrollFrame, scroll);
+    }
+    return scroll->timer != 0;
+}
+
+static double relativeOffset(const SmoothScroll *scroll, ScrollOffset offset) {
+    return (double) (offset.row - scroll->row) * scroll->row_height + offset.pixel;
+}
+
+static double clampOffset(const SmoothScroll *scroll, double offset) {
+    double limit = relativeOffset(scroll, scroll->limit);
+    double top = -(double) scroll->row * scroll->row_height;
+    if (offset > limit) {
+        offset = limit;
+    }
+    return offset > top ? offset : top;
+}
+
+static void rebaseScroll(SmoothScroll *scroll) {
+    if (scroll->row_height <= 0) {
+        return;
+    }
+    Sint64 rows = (Sint64) SDL_floor(scroll->position / scroll->row_height);
+    scroll->row += rows;
+    scroll->position -= (double) rows * scroll->row_height;
+    scroll->target -= (double) rows * scroll->row_height;
+}
+
+int initScroll(SmoothScroll *scroll, SDL_bool instant) {
+    *scroll = (SmoothScroll) {0};
+    scroll->instant = instant;
+    scroll->event_type = SDL_RegisterEvents(1);
+    if (scroll->event_type == (Uint32) -1) {
+        printf("Scroll Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
+
+void destroyScroll(SmoothScroll *scroll) {
+    if (scroll->timer) {
+        SDL_RemoveTimer(scroll->timer);
+        scroll->timer = 0;
+    }
+}
+
+ScrollOffset scrollOffset(Sint64 row, double pixel, int row_height) {
+    Sint64 rows = row_height > 0 ? (Sint64) SDL_floor(pixel / row_height) : 0;
+    ScrollOffset offset = {row + rows, pixel - (double) rows * row_height};
+    return offset.row >= 0 ? offset : (ScrollOffset) {0, 0};
+}
+
+ScrollOffset scrollTarget(const SmoothScroll *scroll) {
+    return scrollOffset(scroll->row, scroll->target, scroll->row_height);
+}
+
+SDL_bool scrollReaches(const SmoothScroll *scroll, ScrollOffset offset) {
+    return scroll->target >= relativeOffset(scroll, offset);
+}
+
+SDL_bool scrollBy(SmoothScroll *scroll, double delta) {
+    scroll->target = clampOffset(scroll, scroll->target + delta);
+    if (!scroll->instant) {
+        if (scroll->timer == 0) {
+            scroll->last_counter = SDL_GetPerformanceCounter();
+        }
+        if (armFrame(scroll)) {
+            return SDL_FALSE;
+        }
+    }
+    scroll->position = scroll->target;
+    scroll->velocity = 0;
+    rebaseScroll(scroll);
+    return SDL_TRUE;
+}
+
+void scrollJump(SmoothScroll *scroll, ScrollOffset offset) {
+    scroll->row = offset.row > 0 ? offset.row : 0;
+    scroll->target = offset.pixel;
+    scroll->position = scroll->target;
+    scroll->velocity = 0;
+    rebaseScroll(scroll);
+}
+
+void scrollShift(SmoothScroll *scroll, Sint64 rows) {
+    scroll->row += rows;
+    if (scroll->row < 0) {
+        double above = (double) -scroll->row * scroll->row_height;
+        scroll->row = 0;
+        scroll->target = scroll->target - above > 0 ? scroll->target - above : 0;
+        scroll->position = scroll->position - above > 0 ? scroll->position - above : 0;
+        rebaseScroll(scroll);
+    }
+}
+
+void setScrollLimit(SmoothScroll *scroll, ScrollOffset limit) {
+    scroll->limit = limit;
+    scroll->target = clampOffset(scroll, scroll->target);
+    scroll->position = clampOffset(scroll, scroll->position);
+    rebaseScroll(scroll);
+}
+
+SDL_bool stepScroll(SmoothScroll *scroll) {
+    scroll->timer = 0;
+    Uint64 now = SDL_GetPerformanceCounter();
+    double dt = (double) (now - scroll->last_counter) / (double) SDL_GetPerformanceFrequency();
+    if (dt > SCROLL_MAX_STEP) {
+        dt = SCROLL_MAX_STEP;
+    }
+    scroll->last_counter = now;
+
+    double offset = scroll->position - scroll->target;
+    double impulse = scroll->velocity + SCROLL_RESPONSE * offset;
+    double decay = SDL_exp(-SCROLL_RESPONSE * dt);
+    offset = (offset + impulse * dt) * decay;
+    scroll->velocity = (scroll->velocity - SCROLL_RESPONSE * impulse * dt) * decay;
+    scroll->position = clampOffset(scroll, scroll->target + offset);
+
+    if ((SDL_fabs(offset) < 0.25 && SDL_fabs(scroll->velocity) < 4.0) || !armFrame(scroll)) {
+        scroll->position = scroll->target;
+        scroll->velocity = 0;
+        rebaseScroll(scroll);
+        return SDL_FALSE;
+    }
+    rebaseScroll(scroll);
+    return SDL_TRUE;
+}
+
+Sint64 overscanRow(Sint64 row) {
+    return row > SCROLL_OVERSCAN_ROWS ? row - SCROLL_OVERSCAN_ROWS : 0;
+}
+
+SDL_bool overscanCovers(const Overscan *overscan, Sint64 row, double pixel, int window_width, int window_height) {
+    double top = (double) (row - overscan->row) * overscan->row_height + pixel;
+    return overscan->valid && overscan->width == window_width && overscan->view_height == window_height &&
+           top >= 0 && top + window_height < overscan->height;
+}
+
+int beginOverscan(Overscan *overscan, SDL_Renderer *renderer, Sint64 row, int row_height, int window_width,
+                  int window_height) {
+    overscan->valid = SDL_FALSE;
+    int height = window_height + 2 * SCROLL_OVERSCAN_ROWS * row_height;
+    if (overscan->texture && (overscan->width != window_width || overscan->height != height)) {
+        SDL_DestroyTexture(overscan->texture);
+        overscan->texture = nullptr;
+    }
+    if (overscan->texture == nullptr) {
+        overscan->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                              window_width, height);
+        if (overscan->texture) {
+            SDL_SetTextureScaleMode(overscan->texture, SDL_ScaleModeLinear);
+            overscan->width = window_width;
+            overscan->height = height;
+        }
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    if (overscan->texture == nullptr || SDL_SetRenderTarget(renderer, overscan->texture) != 0) {
+        SDL_RenderClear(renderer);
+        return -1;
+    }
+    SDL_RenderClear(renderer);
+    overscan->view_height = window_height;
+    overscan->row_height = row_height;
+    overscan->row = overscanRow(row);
+    return 0;
+}
+
+void endOverscan(Overscan *overscan, SDL_Renderer *renderer) {
+    if (overscan->texture && SDL_SetRenderTarget(renderer, nullptr) == 0) {
+        overscan->valid = SDL_TRUE;
+    }
+}
+
+void presentOverscan(Overscan *overscan, SDL_Renderer *renderer, Sint64 row, double pixel) {
+    float top = (float) -((double) (row - overscan->row) * overscan->row_height + pixel);
+    SDL_FRect dst = {0, top, (float) overscan->width, (float) overscan->height};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopyF(renderer, overscan->texture, nullptr, &dst);
+}
+
+void invalidateOverscan(Overscan *overscan) {
+    overscan->valid = SDL_FALSE;
+}
+
+void freeOverscan(Overscan *overscan) {
+    if (overscan->texture) {
+        SDL_DestroyTexture(overscan->texture);
+    }
+    *overscan = (Overscan) {0};
+}
@@ -0,0 +1,74 @@
+#ifndef TEXTEDITOR_SCROLL_H
+#define TEXTEDITOR_SCROLL_H
+
+#include <SDL.h>
+
+#define SCROLL_FRAME_MS 8
+#define SCROLL_RESPONSE 18.0
+#define SCROLL_MAX_STEP 0.05
+#define SCROLL_OVERSCAN_ROWS 8
+
+typedef struct {
+    Sint64 row;
+    double pixel;
+} ScrollOffset;
+
+typedef struct {
+    Sint64 row;
+    int row_height;
+    double position;
+    double velocity;
+    double target;
+    ScrollOffset limit;
+    Uint64 last_counter;
+    SDL_TimerID timer;
+    Uint32 event_type;
+    SDL_bool instant;
+} SmoothScroll;
+
+typedef struct {
+    SDL_Texture *texture;
+    int width;
+    int height;
+    int view_height;
+    int row_height;
+    Sint64 row;
+    SDL_bool valid;
+} Overscan;
+
+int initScroll(SmoothScroll *scroll, SDL_bool instant);
+
+void destroyScroll(SmoothScroll *scroll);
+
+ScrollOffset scrollOffset(Sint64 row, double pixel, int row_height);
+
+ScrollOffset scrollTarget(const SmoothScroll *scroll);
+
+SDL_bool scrollReaches(const SmoothScroll *scroll, ScrollOffset offset);
+
+SDL_bool scrollBy(SmoothScroll *scroll, double delta);
+
+void scrollJump(SmoothScroll *scroll, ScrollOffset offset);
+
+void scrollShift(SmoothScroll *scroll, Sint64 rows);
+
+void setScrollLimit(SmoothScroll *scroll, ScrollOffset limit);
+
+SDL_bool stepScroll(SmoothScroll *scroll);
+
+Sint64 overscanRow(Sint64 row);
+
+SDL_bool overscanCovers(const Overscan *overscan, Sint64 row, double pixel, int window_width, int window_height);
+
+int beginOverscan(Overscan *overscan, SDL_Renderer *renderer, Sint64 row, int row_height, int window_width,
+                  int window_height);
+
+void endOverscan(Overscan *overscan, SDL_Renderer *renderer);
+
+void presentOverscan(Overscan *overscan, SDL_Renderer *renderer, Sint64 row, double pixel);
+
+void invalidateOverscan(Overscan *overscan);
+
+void freeOverscan(Overscan *overscan);
+
+#endif
@@ -0,0 +1,240 @@
+#include "session.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static void resetSession(SessionData *data) {
+    memset(data, 0, sizeof(SessionData));
+    data->magic = SESSION_MAGIC;
+    data->data_size = sizeof(SessionData);
+}
+
+static SDL_bool validSession(const SessionData *data) {
+    return data->magic == SESSION_MAGIC && data->data_size == sizeof(SessionData) &&
+           memchr(data->path, '\0', SESSION_PATH_LENGTH) != nullptr && data->fold_count >= 0 &&
+           data->fold_count <= SESSION_MAX_FOLDS;
+}
+
+static char *absolutePath(const char *path) {
+#ifdef _WIN32
+    return _fullpath(nullptr, path, 0);
+#else
+    return realpath(path, nullptr);
+#endif
+}
+
+static void lockSession(Session *session, SDL_bool locked) {
+#ifndef _WIN32
+    if (session->fd >= 0) {
+        flock(session->fd, locked ? LOCK_EX : LOCK_UN);
+    }
+#endif
+}
+
+static SDL_bool ownsSession(Session *session) {
+    return session->path && strcmp(session->data->path, session->path) == 0;
+}
+
+static int readStamp(const char *path, long long *size, long long *mtime, Uint64 *inode) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+    *size = st.st_size;
+#if defined(__linux__)
+    *mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    *mtime = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    *mtime = st.st_mtime * 1000000000LL;
+#endif
+    *inode = st.st_ino;
+    return 0;
+}
+
+int openSession(Session *session) {
+    *session = (Session) {0};
+    session->fd = -1;
+    char *dir = SDL_GetPrefPath("", "TextEditor");
+    if (dir == nullptr) {
+        printf("Session Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    size_t length = strlen(dir) + sizeof(SESSION_FILE_NAME);
+    session->file = malloc(length);
+    if (session->file == nullptr) {
+        SDL_free(dir);
+        return 1;
+    }
+    snprintf(session->file, length, "%s%s", dir, SESSION_FILE_NAME);
+    SDL_free(dir);
+
+#ifndef _WIN32
+    int fd = open(session->file, O_RDWR | O_CREAT, 0600);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (st.st_size == sizeof(SessionData) || ftruncate(fd, sizeof(SessionData)) == 0)) {
+            void *data = mmap(nullptr, sizeof(SessionData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED) {
+                session->data = data;
+                session->mapped = SDL_TRUE;
+            }
+        }
+        if (session->mapped) {
+            session->fd = fd;
+        } else {
+            close(fd);
+        }
+    }
+#endif
+    if (session->data == nullptr) {
+        session->data = malloc(sizeof(SessionData));
+        if (session->data == nullptr) {
+            free(session->file);
+            session->file = nullptr;
+            return 1;
+        }
+        FILE *file = fopen(session->file, "rb");
+        if (file == nullptr || fread(session->data, sizeof(SessionData), 1, file) != 1) {
+            resetSession(session->data);
+        }
+        if (file) {
+            fclose(file);
+        }
+    }
+    lockSession(session, SDL_TRUE);
+    if (!validSession(session->data)) {
+        resetSession(session->data);
+    }
+    lockSession(session, SDL_FALSE);
+    return 0;
+}
+
+void closeSession(Session *session) {
+    if (session->data == nullptr) {
+        return;
+    }
+#ifndef _WIN32
+    if (session->mapped) {
+        munmap(session->data, sizeof(SessionData));
+        close(session->fd);
+    } else
+#endif
+    {
+        FILE *file = fopen(session->file, "wb");
+        if (file == nullptr || fwrite(session->data, sizeof(SessionData), 1, file) != 1) {
+            printf("Session Error: Could not write %s\n", session->file);
+        }
+        if (file) {
+            fclose(file);
+        }
+        free(session->data);
+    }
+    free(session->file);
+    free(session->source);
+    free(session->path);
+    *session = (Session) {0};
+}
+
+SDL_bool sessionRestores(Session *session, const char *path) {
+    if (session->data == nullptr || session->data->path[0] == '\0') {
+        return SDL_FALSE;
+    }
+    char *absolute = absolutePath(path);
+    lockSession(session, SDL_TRUE);
+    SDL_bool match = absolute && strcmp(absolute, session->data->path) == 0;
+    lockSession(session, SDL_FALSE);
+    free(absolute);
+    return match;
+}
+
+SDL_bool sessionUnchanged(Session *session) {
+    long long size, mtime;
+    Uint64 inode;
+    SessionData *data = session->data;
+    return data && readStamp(data->path, &size, &mtime, &inode) == 0 && size == data->size &&
+           mtime == data->mtime && inode == data->inode;
+}
+
+void sessionSetFile(Session *session, const char *path) {
+    if (session->data == nullptr || path == nullptr) {
+        return;
+    }
+    char *source = strdup(path);
+    free(session->source);
+    session->source = source;
+
+    char *absolute = absolutePath(path);
+    if (absolute && strlen(absolute) >= SESSION_PATH_LENGTH) {
+        free(absolute);
+        absolute = nullptr;
+    }
+    free(session->path);
+    session->path = absolute;
+
+    SessionData *data = session->data;
+    lockSession(session, SDL_TRUE);
+    if (absolute == nullptr) {
+        data->path[0] = '\0';
+    } else {
+        if (strcmp(absolute, data->path) != 0) {
+            data->cursor_pos = 0;
+            data->current_line = 0;
+            data->scroll_row = 0;
+            data->scroll_pixel = 0;
+            data->fold_count = 0;
+            strcpy(data->path, absolute);
+        }
+        if (readStamp(absolute, &data->size, &data->mtime, &data->inode) != 0) {
+            data->size = -1;
+        }
+    }
+    lockSession(session, SDL_FALSE);
+}
+
+void sessionTrack(Session *session, const char *path, int cursor_pos, int current_line, long long scroll_row,
+                  int scroll_pixel) {
+    if (session->data == nullptr || path == nullptr) {
+        return;
+    }
+    if (session->source == nullptr || strcmp(path, session->source) != 0) {
+        sessionSetFile(session, path);
+    }
+    lockSession(session, SDL_TRUE);
+    if (ownsSession(session)) {
+        session->data->cursor_pos = cursor_pos;
+        session->data->current_line = current_line;
+        session->data->scroll_row = scroll_row;
+        session->data->scroll_pixel = scroll_pixel;
+    }
+    lockSession(session, SDL_FALSE);
+}
+
+void sessionSaveFolds(Session *session, FoldTree *folds) {
+    if (session->data == nullptr) {
+        return;
+    }
+    lockSession(session, SDL_TRUE);
+    if (ownsSession(session)) {
+        session->data->fold_count = folds ? collectFolds(folds, session->data->folds, SESSION_MAX_FOLDS) : 0;
+    }
+    lockSession(session, SDL_FALSE);
+}
+
+void sessionRestoreFolds(Session *session, FoldTree *folds, int line_count) {
+    for (int i = 0; session->data && i < session->data->fold_count; i++) {
+        int first = session->data->folds[i][0];
+        int last = session->data->folds[i][1];
+        if (first >= 1 && first <= last && last < line_count) {
+            addFold(folds, first, last);
+        }
+    }
+}
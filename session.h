@@ -0,0 +1,54 @@
+#ifndef TEXTEDITOR_SESSION_H
+#define TEXTEDITOR_SESSION_H
+
+#include <SDL.h>
+#include "fold.h"
+
+#define SESSION_MAGIC 0x31535854u
+#define SESSION_PATH_LENGTH 4096
+#define SESSION_MAX_FOLDS 1024
+#define SESSION_FILE_NAME "session"
+
+typedef struct {
+    Uint32 magic;
+    Uint32 data_size;
+    long long size;
+    long long mtime;
+    Uint64 inode;
+    long long scroll_row;
+    int cursor_pos;
+    int current_line;
+    int scroll_pixel;
+    int fold_count;
+    char path[SESSION_PATH_LENGTH];
+    int folds[SESSION_MAX_FOLDS][2];
+} SessionData;
+
+typedef struct {
+    SessionData *data;
+    char *file;
+    char *source;
+    char *path;
+    int fd;
+    SDL_bool mapped;
+    SDL_bool pending;
+} Session;
+
+int openSession(Session *session);
+
+void closeSession(Session *session);
+
+SDL_bool sessionRestores(Session *session, const char *path);
+
+SDL_bool sessionUnchanged(Session *session);
+
+void sessionSetFile(Session *session, const char *path);
+
+void sessionTrack(Session *session, const char *path, int cursor_pos, int current_line, long long scroll_row,
+                  int scroll_pixel);
+
+void sessionSaveFolds(Session *session, FoldTree *folds);
+
+void sessionRestoreFolds(Session *session, FoldTree *folds, int line_count);
+
+#endif
@@ -0,0 +1,245 @@
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "diff.h"
+
+int initInputQueue(InputQueue *queue) {
+    memset(queue, 0, sizeof(*queue));
+    queue->lock = SDL_CreateMutex();
+    queue->pending = SDL_CreateSemaphore(0);
+    queue->events = malloc(INPUT_QUEUE_SIZE * sizeof(InputEvent));
+    if (queue->lock == nullptr || queue->pending == nullptr || queue->events == nullptr) {
+        printf("Input queue Error: %s\n", SDL_GetError());
+        destroyInputQueue(queue);
+        return 1;
+    }
+    queue->capacity = INPUT_QUEUE_SIZE;
+    return 0;
+}
+
+void destroyInputQueue(InputQueue *queue) {
+    if (queue->lock) {
+        SDL_DestroyMutex(queue->lock);
+    }
+    if (queue->pending) {
+        SDL_DestroySemaphore(queue->pending);
+    }
+    free(queue->events);
+    memset(queue, 0, sizeof(*queue));
+}
+
+int postInput(InputQueue *queue, const InputEvent *input) {
+    SDL_LockMutex(queue->lock);
+    if (queue->count == queue->capacity) {
+        InputEvent *events = malloc(queue->capacity * 2 * sizeof(InputEvent));
+        if (events == nullptr) {
+            SDL_UnlockMutex(queue->lock);
+            printf("Error: Not enough memory to queue input.\n");
+            return -1;
+        }
+        for (int i = 0; i < queue->count; i++) {
+            events[i] = queue->events[(queue->head + i) % queue->capacity];
+        }
+        free(queue->events);
+        queue->events = events;
+        queue->head = 0;
+        queue->capacity *= 2;
+    }
+    queue->events[(queue->head + queue->count) % queue->capacity] = *input;
+    queue->count++;
+    SDL_UnlockMutex(queue->lock);
+    SDL_SemPost(queue->pending);
+    return 0;
+}
+
+SDL_bool takeInput(InputQueue *queue, InputEvent *input, Uint32 timeout) {
+    if (SDL_SemWaitTimeout(queue->pending, timeout) != 0) {
+        return SDL_FALSE;
+    }
+    SDL_LockMutex(queue->lock);
+    *input = queue->events[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    SDL_UnlockMutex(queue->lock);
+    return SDL_TRUE;
+}
+
+SDL_bool inputPending(InputQueue *queue) {
+    return SDL_SemValue(queue->pending) > 0;
+}
+
+int initExchange(SnapshotExchange *exchange) {
+    memset(exchange, 0, sizeof(*exchange));
+    exchange->event_type = SDL_RegisterEvents(1);
+    if (exchange->event_type == (Uint32) -1) {
+        printf("Snapshot Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
+
+void freeSnapshot(ViewSnapshot *snapshot) {
+    if (snapshot) {
+        free(snapshot->rows);
+        free(snapshot);
+    }
+}
+
+void destroyExchange(SnapshotExchange *exchange) {
+    freeSnapshot(SDL_AtomicSetPtr(&exchange->ready, nullptr));
+    freeSnapshot(SDL_AtomicSetPtr(&exchange->spare, nullptr));
+}
+
+static void retireSnapshot(SnapshotExchange *exchange, ViewSnapshot *snapshot) {
+    freeSnapshot(SDL_AtomicSetPtr(&exchange->spare, snapshot));
+}
+
+ViewSnapshot *acquireSnapshot(SnapshotExchange *exchange, int row_count) {
+    ViewSnapshot *snapshot = SDL_AtomicSetPtr(&exchange->spare, nullptr);
+    if (snapshot == nullptr) {
+        snapshot = calloc(1, sizeof(ViewSnapshot));
+        if (snapshot == nullptr) {
+            return nullptr;
+        }
+    }
+    if (snapshot->row_capacity < row_count) {
+        SnapshotRow *rows = realloc(snapshot->rows, row_count * sizeof(SnapshotRow));
+        if (rows == nullptr) {
+            freeSnapshot(snapshot);
+            return nullptr;
+        }
+        snapshot->rows = rows;
+        snapshot->row_capacity = row_count;
+    }
+    snapshot->row_count = 0;
+    snapshot->first_row = 0;
+    snapshot->cursor_row = -1;
+    snapshot->cursor_pos = 0;
+    snapshot->selected = -1;
+    snapshot->column_count = 0;
+    snapshot->header[0] = '\0';
+    return snapshot;
+}
+
+void publishSnapshot(SnapshotExchange *exchange, ViewSnapshot *snapshot) {
+    ViewSnapshot *unread = SDL_AtomicSetPtr(&exchange->ready, snapshot);
+    if (unread) {
+        retireSnapshot(exchange, unread);
+    }
+    if (SDL_AtomicCAS(&exchange->notified, 0, 1)) {
+        SDL_Event event = {0};
+        event.type = exchange->event_type;
+        SDL_PushEvent(&event);
+    }
+}
+
+ViewSnapshot *takeSnapshot(SnapshotExchange *exchange, ViewSnapshot *current) {
+    SDL_AtomicSet(&exchange->notified, 0);
+    ViewSnapshot *latest = SDL_AtomicSetPtr(&exchange->ready, nullptr);
+    if (latest == nullptr) {
+        return current;
+    }
+    if (current) {
+        retireSnapshot(exchange, current);
+    }
+    return latest;
+}
+
+static Sint64 firstRow(const ViewSnapshot *snapshot, int line_height) {
+    Sint64 row = snapshot->top_row - SNAPSHOT_TEXT_Y / line_height - 1;
+    return row > 0 ? row : 0;
+}
+
+static SDL_bool rowFits(const ViewSnapshot *snapshot, Sint64 row, int line_height) {
+    return snapshot->row_count < snapshot->row_capacity &&
+           SNAPSHOT_TEXT_Y + (row - snapshot->top_row) * line_height < snapshot->height;
+}
+
+void snapshotDocument(ViewSnapshot *snapshot, Document *doc, const ColumnView *columns, const Uint8 *marks,
+                      int mark_count, int cursor_pos, int current_line, int line_height) {
+    snapshot->kind = VIEW_TEXT;
+    snapshot->first_row = firstRow(snapshot, line_height);
+    for (int i = rowToLine(&doc->folds, (int) snapshot->first_row), row = (int) snapshot->first_row;
+         i < doc->line_count && rowFits(snapshot, row, line_height); i = nextVisibleLine(&doc->folds, i), row++) {
+        SnapshotRow *out = &snapshot->rows[snapshot->row_count++];
+        out->line_number = i + 1;
+        out->mark = i < mark_count ? marks[i] : MARK_NONE;
+        out->folded = foldedAt(&doc->folds, i);
+        out->patched = 0;
+        strcpy(out->text, doc->lines[i]);
+    }
+    if (current_line >= 0) {
+        snapshot->cursor_row = lineToRow(&doc->folds, current_line);
+        snapshot->cursor_pos = cursor_pos;
+    }
+    if (columns) {
+        snapshot->column_count = columns->column_count;
+        snapshot->delimiter = columns->delimiter;
+        memcpy(snapshot->offsets, columns->offsets, (columns->column_count + 1) * sizeof(int));
+    }
+}
+
+void snapshotPaged(ViewSnapshot *snapshot, PagedFile *paged, int cursor_pos, int current_line, int line_height) {
+    snapshot->kind = VIEW_TEXT;
+    snapshot->first_row = firstRow(snapshot, line_height);
+    pagedEnsureLines(paged, snapshot->first_row + snapshot->row_capacity);
+    for (long i = snapshot->first_row; i < pagedLineCount(paged) && rowFits(snapshot, i, line_height); i++) {
+        SnapshotRow *out = &snapshot->rows[snapshot->row_count++];
+        out->line_number = i + 1;
+        out->mark = MARK_NONE;
+        out->folded = 0;
+        out->patched = 0;
+        pagedGetLine(paged, i, out->text);
+    }
+    snapshot->cursor_row = current_line;
+    snapshot->cursor_pos = cursor_pos;
+}
+
+void snapshotHex(ViewSnapshot *snapshot, const HexView *hex, int line_height) {
+    snapshot->kind = VIEW_HEX;
+    snapshot->first_row = firstRow(snapshot, line_height);
+    snapshot->offset_digits = hex->offset_digits;
+    for (size_t row = snapshot->first_row; row < hexRowCount(hex) && rowFits(snapshot, (Sint64) row, line_height);
+         row++) {
+        SnapshotRow *out = &snapshot->rows[snapshot->row_count++];
+        out->line_number = 0;
+        out->mark = MARK_NONE;
+        out->folded = 0;
+        out->patched = hexFormatRow(hex, row, out->text);
+    }
+    snapshot->cursor_row = (long) (hex->cursor / HEX_ROW_BYTES);
+    snapshot->cursor_pos = hexCursorColumn(hex);
+}
+
+void snapshotPicker(ViewSnapshot *snapshot, FilePicker *picker, int line_height) {
+    snapshot->kind = VIEW_PICKER;
+    snprintf(snapshot->header, sizeof(snapshot->header), "Open %s%s%s", picker->dir,
+             strcmp(picker->dir, "/") == 0 ? "" : "/", picker->query);
+
+    int rows = (snapshot->window_height - 10 - 2 * line_height) / line_height;
+    if (rows < 1) {
+        rows = 1;
+    }
+    if (rows > snapshot->row_capacity) {
+        rows = snapshot->row_capacity;
+    }
+    if (picker->selected < picker->first_row) {
+        picker->first_row = picker->selected;
+    } else if (picker->selected >= picker->first_row + rows) {
+        picker->first_row = picker->selected - rows + 1;
+    }
+
+    for (int i = picker->first_row; i < picker->match_count && i < picker->first_row + rows; i++) {
+        const PickerEntry *entry = &picker->listing->entries[picker->matches[i].entry];
+        SnapshotRow *out = &snapshot->rows[snapshot->row_count++];
+        out->line_number = 0;
+        out->mark = MARK_NONE;
+        out->folded = 0;
+        out->patched = 0;
+        snprintf(out->text, sizeof(out->text), entry->directory ? "%s/" : "%s", entry->name);
+        if (i == picker->selected) {
+            snapshot->selected = snapshot->row_count - 1;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef TEXTEDITOR_SNAPSHOT_H
+#define TEXTEDITOR_SNAPSHOT_H
+
+#include <SDL.h>
+#include "document.h"
+#include "columns.h"
+#include "paged.h"
+#include "hex.h"
+#include "picker.h"
+
+#define INPUT_QUEUE_SIZE 256
+#define SNAPSHOT_HEADER_LENGTH 1024
+#define SNAPSHOT_TEXT_Y 50
+
+enum {
+    VIEW_TEXT,
+    VIEW_HEX,
+    VIEW_PICKER
+};
+
+typedef struct {
+    SDL_Event event;
+    SDL_Keymod mod;
+    int window_width;
+    int window_height;
+} InputEvent;
+
+typedef struct {
+    SDL_mutex *lock;
+    SDL_sem *pending;
+    InputEvent *events;
+    int head;
+    int count;
+    int capacity;
+} InputQueue;
+
+typedef struct {
+    long line_number;
+    int mark;
+    int folded;
+    Uint32 patched;
+    char text[MAX_LINE_LENGTH];
+} SnapshotRow;
+
+typedef struct {
+    Uint64 version;
+    Uint64 content;
+    Uint32 events;
+    Uint32 raise_count;
+    int kind;
+    int window_width;
+    int window_height;
+    Sint64 row;
+    double position;
+    Sint64 top_row;
+    int height;
+    int x;
+    Sint64 first_row;
+    int row_count;
+    int row_capacity;
+    long cursor_row;
+    int cursor_pos;
+    int selected;
+    int offset_digits;
+    int column_count;
+    char delimiter;
+    int offsets[COLUMN_MAX_COUNT + 1];
+    char header[SNAPSHOT_HEADER_LENGTH];
+    SnapshotRow *rows;
+} ViewSnapshot;
+
+typedef struct {
+    void *ready;
+    void *spare;
+    SDL_atomic_t notified;
+    Uint32 event_type;
+} SnapshotExchange;
+
+int initInputQueue(InputQueue *queue);
+
+void destroyInputQueue(InputQueue *queue);
+
+int postInput(InputQueue *queue, const InputEvent *input);
+
+SDL_bool takeInput(InputQueue *queue, InputEvent *input, Uint32 timeout);
+
+SDL_bool inputPending(InputQueue *queue);
+
+int initExchange(SnapshotExchange *exchange);
+
+void destroyExchange(SnapshotExchange *exchange);
+
+ViewSnapshot *acquireSnapshot(SnapshotExchange *exchange, int row_count);
+
+void publishSnapshot(SnapshotExchange *exchange, ViewSnapshot *snapshot);
+
+ViewSnapshot *takeSnapshot(SnapshotExchange *exchange, ViewSnapshot *current);
+
+void freeSnapshot(ViewSnapshot *snapshot);
+
+void snapshotDocument(ViewSnapshot *snapshot, Document *doc, const ColumnView *columns, const Uint8 *marks,
+                      int mark_count, int cursor_pos, int current_line, int line_height);
+
+void snapshotPaged(ViewSnapshot *snapshot, PagedFile *paged, int cursor_pos, int current_line, int line_height);
+
+void snapshotHex(ViewSnapshot *snapshot, const HexView *hex, int line_height);
+
+void snapshotPicker(ViewSnapshot *snapshot, FilePicker *picker, int line_height);
+
+#endif
@@ -0,0 +1,56 @@
+#include "startup.h"
+#include <stdio.h>
+#include "tinyfiledialogs.h"
+
+static int probeDialogs(void *data) {
+    StartupTimer *timer = data;
+    Uint64 start = SDL_GetPerformanceCounter();
+    tinyfd_openFileDialog("tinyfd_query", "", 0, nullptr, nullptr, 0);
+    timer->probe_ticks = SDL_GetPerformanceCounter() - start;
+    return 0;
+}
+
+void startupBegin(StartupTimer *timer, SDL_bool enabled) {
+    *timer = (StartupTimer) {0};
+    timer->enabled = enabled;
+    timer->start = SDL_GetPerformanceCounter();
+}
+
+void startupMark(StartupTimer *timer, const char *name) {
+    if (timer->done || timer->phase_count == STARTUP_MAX_PHASES) {
+        return;
+    }
+    timer->phases[timer->phase_count++] = (StartupPhase) {name, SDL_GetPerformanceCounter()};
+}
+
+void startupFinish(StartupTimer *timer) {
+    if (timer->done) {
+        return;
+    }
+    startupMark(timer, "first frame");
+    timer->done = SDL_TRUE;
+    SDL_AtomicSetPtr((void **) &timer->probe, SDL_CreateThread(probeDialogs, "dialog probe", timer));
+
+    if (timer->enabled) {
+        double freq = (double) SDL_GetPerformanceFrequency();
+        Uint64 last = timer->start;
+        printf("Startup:\n");
+        for (int i = 0; i < timer->phase_count; i++) {
+            printf("  %-14s %8.3f ms\n", timer->phases[i].name, (timer->phases[i].counter - last) * 1000.0 / freq);
+            last = timer->phases[i].counter;
+        }
+        printf("  %-14s %8.3f ms\n", "total", (last - timer->start) * 1000.0 / freq);
+    }
+}
+
+void waitDialogProbe(StartupTimer *timer) {
+    SDL_Thread *probe = SDL_AtomicSetPtr((void **) &timer->probe, nullptr);
+    if (probe == nullptr) {
+        return;
+    }
+    SDL_WaitThread(probe, nullptr);
+    if (timer->enabled) {
+        printf("Dialog backend: %s, detected in %.3f ms in the background\n", tinyfd_response,
+               timer->probe_ticks * 1000.0 / (double) SDL_GetPerformanceFrequency());
+    }
+}
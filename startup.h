@@ -0,0 +1,31 @@
+#ifndef TEXTEDITOR_STARTUP_H
+#define TEXTEDITOR_STARTUP_H
+
+#include <SDL.h>
+
+#define STARTUP_MAX_PHASES 16
+
+typedef struct {
+    const char *name;
+    Uint64 counter;
+} StartupPhase;
+
+typedef struct {
+    SDL_bool enabled;
+    SDL_bool done;
+    Uint64 start;
+    StartupPhase phases[STARTUP_MAX_PHASES];
+    int phase_count;
+    SDL_Thread *probe;
+    Uint64 probe_ticks;
+} StartupTimer;
+
+void startupBegin(StartupTimer *timer, SDL_bool enabled);
+
+void startupMark(StartupTimer *timer, const char *name);
+
+void startupFinish(StartupTimer *timer);
+
+void waitDialogProbe(StartupTimer *timer);
+
+#endif
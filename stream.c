@@ -0,0 +1,285 @@
+#include "stream.h"
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const char *const compression_names[] = {"none", "gzip", "zstd"};
+
+static SDL_bool hasSuffix(const char *path, const char *suffix) {
+    size_t length = strlen(path);
+    size_t suffix_length = strlen(suffix);
+    return length > suffix_length && SDL_strcasecmp(path + length - suffix_length, suffix) == 0;
+}
+
+static int magicCompression(const unsigned char *p, size_t size) {
+    if (size >= 2 && p[0] == 0x1F && p[1] == 0x8B) {
+        return COMPRESSION_GZIP;
+    }
+    if (size >= 4 && p[0] == 0x28 && p[1] == 0xB5 && p[2] == 0x2F && p[3] == 0xFD) {
+        return COMPRESSION_ZSTD;
+    }
+    return COMPRESSION_NONE;
+}
+
+int compressionForPath(const char *path) {
+    if (hasSuffix(path, ".gz")) {
+        return COMPRESSION_GZIP;
+    }
+    if (hasSuffix(path, ".zst")) {
+        return COMPRESSION_ZSTD;
+    }
+    return COMPRESSION_NONE;
+}
+
+int detectCompression(const char *path) {
+    unsigned char magic[4];
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return COMPRESSION_NONE;
+    }
+    size_t got = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
+    return magicCompression(magic, got);
+}
+
+const char *compressionName(int compression) {
+    return compression_names[compression];
+}
+
+static void *createCodec(int compression, SDL_bool writing) {
+    if (compression == COMPRESSION_GZIP) {
+        z_stream *z = calloc(1, sizeof(z_stream));
+        if (z == nullptr) {
+            return nullptr;
+        }
+        int result = writing ? deflateInit2(z, STREAM_GZIP_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)
+                             : inflateInit2(z, 15 + 32);
+        if (result != Z_OK) {
+            free(z);
+            return nullptr;
+        }
+        return z;
+    }
+#ifdef HAVE_ZSTD
+    if (compression == COMPRESSION_ZSTD && writing) {
+        ZSTD_CCtx *context = ZSTD_createCCtx();
+        if (context) {
+            ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, STREAM_ZSTD_LEVEL);
+        }
+        return context;
+    }
+    if (compression == COMPRESSION_ZSTD) {
+        return ZSTD_createDCtx();
+    }
+#endif
+    return nullptr;
+}
+
+static void freeCodec(Stream *stream) {
+    if (stream->codec == nullptr) {
+        return;
+    }
+    if (stream->compression == COMPRESSION_GZIP) {
+        if (stream->writing) {
+            deflateEnd(stream->codec);
+        } else {
+            inflateEnd(stream->codec);
+        }
+        free(stream->codec);
+    }
+#ifdef HAVE_ZSTD
+    if (stream->compression == COMPRESSION_ZSTD && stream->writing) {
+        ZSTD_freeCCtx(stream->codec);
+    } else if (stream->compression == COMPRESSION_ZSTD) {
+        ZSTD_freeDCtx(stream->codec);
+    }
+#endif
+    stream->codec = nullptr;
+}
+
+static int openStream(Stream *stream, int compression, SDL_bool writing) {
+    stream->compression = compression;
+    if (compression != COMPRESSION_NONE) {
+        stream->codec = createCodec(compression, writing);
+        if (stream->codec == nullptr) {
+            printf("Error: %s support is not available.\n", compressionName(compression));
+            closeStream(stream);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int openReadStream(Stream *stream, FILE *file) {
+    memset(stream, 0, sizeof(*stream));
+    stream->file = file;
+    stream->buffer = malloc(STREAM_CHUNK_SIZE);
+    if (stream->buffer == nullptr) {
+        return -1;
+    }
+    stream->length = fread(stream->buffer, 1, STREAM_CHUNK_SIZE, file);
+    stream->eof = stream->length == 0;
+    return openStream(stream, magicCompression(stream->buffer, stream->length), SDL_FALSE);
+}
+
+int openWriteStream(Stream *stream, FILE *file, int compression) {
+    memset(stream, 0, sizeof(*stream));
+    stream->file = file;
+    stream->writing = SDL_TRUE;
+    if (compression != COMPRESSION_NONE) {
+        stream->buffer = malloc(STREAM_CHUNK_SIZE * 2);
+        if (stream->buffer == nullptr) {
+            return -1;
+        }
+    }
+    return openStream(stream, compression, SDL_TRUE);
+}
+
+static SDL_bool refillStream(Stream *stream) {
+    if (stream->pos < stream->length) {
+        return SDL_TRUE;
+    }
+    if (stream->eof) {
+        return SDL_FALSE;
+    }
+    stream->length = fread(stream->buffer, 1, STREAM_CHUNK_SIZE, stream->file);
+    stream->pos = 0;
+    stream->eof = stream->length == 0;
+    stream->failed = stream->failed || ferror(stream->file);
+    return stream->length > 0;
+}
+
+static size_t readPlain(Stream *stream, unsigned char *data, size_t size) {
+    size_t buffered = stream->length - stream->pos < size ? stream->length - stream->pos : size;
+    memcpy(data, stream->buffer + stream->pos, buffered);
+    stream->pos += buffered;
+    if (buffered == size || stream->eof) {
+        return buffered;
+    }
+    size_t got = fread(data + buffered, 1, size - buffered, stream->file);
+    stream->eof = got == 0;
+    stream->failed = stream->failed || ferror(stream->file);
+    return buffered + got;
+}
+
+static size_t readGzip(Stream *stream, unsigned char *data, size_t size) {
+    z_stream *z = stream->codec;
+    size_t produced = 0;
+    while (produced < size && !stream->failed) {
+        SDL_bool more = refillStream(stream);
+        if (!more && !stream->in_frame) {
+            break;
+        }
+        z->next_in = stream->buffer + stream->pos;
+        z->avail_in = (uInt) (stream->length - stream->pos);
+        z->next_out = data + produced;
+        z->avail_out = (uInt) (size - produced);
+        int result = inflate(z, Z_NO_FLUSH);
+        stream->pos = stream->length - z->avail_in;
+        stream->failed = (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) ||
+                         (!more && size - z->avail_out == produced);
+        produced = size - z->avail_out;
+        stream->in_frame = result != Z_STREAM_END;
+        if (result == Z_STREAM_END) {
+            inflateReset(z);
+        }
+    }
+    return produced;
+}
+
+#ifdef HAVE_ZSTD
+static size_t readZstd(Stream *stream, unsigned char *data, size_t size) {
+    ZSTD_outBuffer out = {data, size, 0};
+    while (out.pos < size && !stream->failed) {
+        SDL_bool more = refillStream(stream);
+        if (!more && !stream->in_frame) {
+            break;
+        }
+        size_t produced = out.pos;
+        ZSTD_inBuffer in = {stream->buffer, stream->length, stream->pos};
+        size_t pending = ZSTD_decompressStream(stream->codec, &out, &in);
+        stream->pos = in.pos;
+        stream->failed = ZSTD_isError(pending) || (!more && out.pos == produced);
+        stream->in_frame = pending != 0;
+    }
+    return out.pos;
+}
+#endif
+
+size_t readStream(Stream *stream, void *data, size_t size) {
+    switch (stream->compression) {
+        case COMPRESSION_GZIP:
+            return readGzip(stream, data, size);
+#ifdef HAVE_ZSTD
+        case COMPRESSION_ZSTD:
+            return readZstd(stream, data, size);
+#endif
+        default:
+            return readPlain(stream, data, size);
+    }
+}
+
+static void compressChunk(Stream *stream, SDL_bool finish) {
+    unsigned char *output = stream->buffer + STREAM_CHUNK_SIZE;
+    if (stream->compression == COMPRESSION_GZIP) {
+        z_stream *z = stream->codec;
+        z->next_in = stream->buffer;
+        z->avail_in = (uInt) stream->length;
+        int result;
+        do {
+            z->next_out = output;
+            z->avail_out = STREAM_CHUNK_SIZE;
+            result = deflate(z, finish ? Z_FINISH : Z_NO_FLUSH);
+            size_t produced = STREAM_CHUNK_SIZE - z->avail_out;
+            stream->failed = stream->failed || result == Z_STREAM_ERROR ||
+                             fwrite(output, 1, produced, stream->file) != produced;
+        } while (!stream->failed && (finish ? result != Z_STREAM_END : z->avail_out == 0));
+    }
+#ifdef HAVE_ZSTD
+    if (stream->compression == COMPRESSION_ZSTD) {
+        ZSTD_inBuffer in = {stream->buffer, stream->length, 0};
+        size_t remaining;
+        do {
+            ZSTD_outBuffer out = {output, STREAM_CHUNK_SIZE, 0};
+            remaining = ZSTD_compressStream2(stream->codec, &out, &in, finish ? ZSTD_e_end : ZSTD_e_continue);
+            stream->failed = stream->failed || ZSTD_isError(remaining) ||
+                             fwrite(output, 1, out.pos, stream->file) != out.pos;
+        } while (!stream->failed && (finish ? remaining != 0 : in.pos < in.size));
+    }
+#endif
+    stream->length = 0;
+}
+
+int writeStream(Stream *stream, const void *data, size_t size) {
+    if (stream->compression == COMPRESSION_NONE) {
+        stream->failed = stream->failed || fwrite(data, 1, size, stream->file) != size;
+        return stream->failed ? -1 : 0;
+    }
+    const unsigned char *bytes = data;
+    while (size > 0 && !stream->failed) {
+        size_t room = STREAM_CHUNK_SIZE - stream->length;
+        size_t count = size < room ? size : room;
+        memcpy(stream->buffer + stream->length, bytes, count);
+        stream->length += count;
+        bytes += count;
+        size -= count;
+        if (stream->length == STREAM_CHUNK_SIZE) {
+            compressChunk(stream, SDL_FALSE);
+        }
+    }
+    return stream->failed ? -1 : 0;
+}
+
+int closeStream(Stream *stream) {
+    if (stream->writing && stream->codec && !stream->failed) {
+        compressChunk(stream, SDL_TRUE);
+    }
+    freeCodec(stream);
+    free(stream->buffer);
+    stream->buffer = nullptr;
+    return stream->failed ? -1 : 0;
+}
@@ -0,0 +1,46 @@
+#ifndef TEXTEDITOR_STREAM_H
+#define TEXTEDITOR_STREAM_H
+
+#include <SDL.h>
+#include <stdio.h>
+
+#define STREAM_CHUNK_SIZE (1 << 18)
+#define STREAM_GZIP_LEVEL 6
+#define STREAM_ZSTD_LEVEL 3
+
+enum {
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,
+    COMPRESSION_ZSTD
+};
+
+typedef struct {
+    FILE *file;
+    int compression;
+    SDL_bool writing;
+    void *codec;
+    unsigned char *buffer;
+    size_t length;
+    size_t pos;
+    SDL_bool eof;
+    SDL_bool in_frame;
+    SDL_bool failed;
+} Stream;
+
+int compressionForPath(const char *path);
+
+int detectCompression(const char *path);
+
+const char *compressionName(int compression);
+
+int openReadStream(Stream *stream, FILE *file);
+
+int openWriteStream(Stream *stream, FILE *file, int compression);
+
+size_t readStream(Stream *stream, void *data, size_t size);
+
+int writeStream(Stream *stream, const void *data, size_t size);
+
+int closeStream(Stream *stream);
+
+#endif
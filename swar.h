@@ -0,0 +1,15 @@
+#ifndef TEXTEDITOR_SWAR_H
+#define TEXTEDITOR_SWAR_H
+
+#include <SDL.h>
+
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+#define SWAR_BYTE_INDEX 0x0001020304050607ULL
+
+static inline Uint64 swarMatchBytes(Uint64 word, Uint64 pattern) {
+    Uint64 bytes = word ^ pattern;
+    return (bytes - SWAR_ONES) & ~bytes & SWAR_HIGHS;
+}
+
+#endif
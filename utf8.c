@@ -0,0 +1,179 @@
+#include "utf8.h"
+#include "swar.h"
+#include <string.h>
+
+static const Uint32 extending_ranges[][2] = {
+        {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x0610, 0x061A}, {0x064B, 0x065F},
+        {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF},
+        {0x200C, 0x200D}, {0x20D0, 0x20FF}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0x1F3FB, 0x1F3FF},
+        {0xE0020, 0xE007F}, {0xE0100, 0xE01EF}
+};
+
+int utf8SequenceLength(const unsigned char *p, size_t available) {
+    int size = 0;
+    if (p[0] >= 0xC2 && p[0] < 0xE0) {
+        size = 2;
+    } else if (p[0] >= 0xE0 && p[0] < 0xF0) {
+        size = 3;
+    } else if (p[0] >= 0xF0 && p[0] < 0xF5) {
+        size = 4;
+    }
+    if (size == 0 || available < (size_t) size) {
+        return 0;
+    }
+    for (int i = 1; i < size; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    if ((p[0] == 0xE0 && p[1] < 0xA0) || (p[0] == 0xED && p[1] >= 0xA0) || (p[0] == 0xF0 && p[1] < 0x90) ||
+        (p[0] == 0xF4 && p[1] >= 0x90)) {
+        return 0;
+    }
+    return size;
+}
+
+size_t utf8ValidPrefix(const unsigned char *data, size_t size, SDL_bool *multibyte) {
+    size_t i = 0;
+    while (i < size) {
+        if (i + 8 <= size) {
+            Uint64 word;
+            memcpy(&word, data + i, sizeof(word));
+            if ((word & SWAR_HIGHS) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        if (data[i] < 0x80) {
+            i++;
+            continue;
+        }
+        int length = utf8SequenceLength(data + i, size - i);
+        if (length == 0) {
+            break;
+        }
+        *multibyte = SDL_TRUE;
+        i += length;
+    }
+    return i;
+}
+
+Uint32 utf8Decode(const char *text, int length, int *size) {
+    const unsigned char *p = (const unsigned char *) text;
+    if (p[0] < 0x80) {
+        *size = 1;
+        return p[0];
+    }
+    *size = utf8SequenceLength(p, length);
+    if (*size == 0) {
+        *size = 1;
+        return UTF8_REPLACEMENT;
+    }
+    Uint32 codepoint = p[0] & (0xFF >> (*size + 1));
+    for (int i = 1; i < *size; i++) {
+        codepoint = codepoint << 6 | (p[i] & 0x3F);
+    }
+    return codepoint;
+}
+
+int utf8Encode(Uint32 codepoint, char *out) {
+    if (codepoint < 0x80) {
+        out[0] = (char) codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char) (0xC0 | codepoint >> 6);
+        out[1] = (char) (0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char) (0xE0 | codepoint >> 12);
+        out[1] = (char) (0x80 | (codepoint >> 6 & 0x3F));
+        out[2] = (char) (0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char) (0xF0 | codepoint >> 18);
+    out[1] = (char) (0x80 | (codepoint >> 12 & 0x3F));
+    out[2] = (char) (0x80 | (codepoint >> 6 & 0x3F));
+    out[3] = (char) (0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+static SDL_bool extendsCluster(Uint32 codepoint) {
+    for (size_t i = 0; i < SDL_arraysize(extending_ranges); i++) {
+        if (codepoint >= extending_ranges[i][0] && codepoint <= extending_ranges[i][1]) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+static SDL_bool regionalIndicator(Uint32 codepoint) {
+    return codepoint >= 0x1F1E6 && codepoint <= 0x1F1FF;
+}
+
+int utf8Next(const char *text, int pos) {
+    int length = strlen(text);
+    if (pos >= length) {
+        return length;
+    }
+    if ((unsigned char) text[pos] < 0x80 && (unsigned char) text[pos + 1] < 0x80) {
+        return pos + 1;
+    }
+
+    int size;
+    Uint32 codepoint = utf8Decode(text + pos, length - pos, &size);
+    pos += size;
+    if (regionalIndicator(codepoint) && pos < length &&
+        regionalIndicator(utf8Decode(text + pos, length - pos, &size))) {
+        pos += size;
+    }
+    while (pos < length) {
+        Uint32 next = utf8Decode(text + pos, length - pos, &size);
+        if (codepoint == UTF8_ZERO_WIDTH_JOINER || extendsCluster(next)) {
+            codepoint = next;
+            pos += size;
+        } else {
+            break;
+        }
+    }
+    return pos;
+}
+
+int utf8Prev(const char *text, int pos) {
+    if (pos <= 0) {
+        return 0;
+    }
+    if ((unsigned char) text[pos - 1] < 0x80 && (pos == 1 || (unsigned char) text[pos - 2] < 0x80)) {
+        return pos - 1;
+    }
+    int previous = 0;
+    for (int i = 0; i < pos;) {
+        previous = i;
+        i = utf8Next(text, i);
+    }
+    return previous;
+}
+
+size_t utf8Cut(const char *text, size_t length, size_t limit) {
+    if (limit >= length) {
+        return length;
+    }
+    size_t cut = limit;
+    while (cut > 0 && limit - cut < 3 && ((unsigned char) text[cut] & 0xC0) == 0x80) {
+        cut--;
+    }
+    return cut < limit && (unsigned char) text[cut] >= 0xC0 ? cut : limit;
+}
+
+int utf8Snap(const char *text, int pos) {
+    int length = strlen(text);
+    if (pos >= length) {
+        return length;
+    }
+    int boundary = 0;
+    for (int i = 0; i <= pos; i = utf8Next(text, i)) {
+        boundary = i;
+    }
+    return boundary;
+}
@@ -0,0 +1,26 @@
+#ifndef TEXTEDITOR_UTF8_H
+#define TEXTEDITOR_UTF8_H
+
+#include <SDL.h>
+#include <stddef.h>
+
+#define UTF8_REPLACEMENT 0xFFFD
+#define UTF8_ZERO_WIDTH_JOINER 0x200D
+
+int utf8SequenceLength(const unsigned char *p, size_t available);
+
+size_t utf8ValidPrefix(const unsigned char *data, size_t size, SDL_bool *multibyte);
+
+size_t utf8Cut(const char *text, size_t length, size_t limit);
+
+Uint32 utf8Decode(const char *text, int length, int *size);
+
+int utf8Encode(Uint32 codepoint, char *out);
+
+int utf8Next(const char *text, int pos);
+
+int utf8Prev(const char *text, int pos);
+
+int utf8Snap(const char *text, int pos);
+
+#endif
@@ -0,0 +1,423 @@
+#include "watch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "diff.h"
+#include "filemap.h"
+#include "utf8.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+static long segmentEnd(const char *data, long pos, long size) {
+    long limit = pos + (long) utf8Cut(data + pos, size - pos, MAX_LINE_LENGTH - 1);
+    const char *newline = memchr(data + pos, '\n', limit - pos);
+    return newline ? newline - data + 1 : limit;
+}
+
+static SDL_bool openTail(const char *data, long size, long last_start) {
+    return size > 0 && data[size - 1] != '\n' && size - last_start < MAX_LINE_LENGTH - 1;
+}
+
+static int readStamp(const char *path, long long *size, long long *mtime) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+    *size = st.st_size;
+#if defined(__linux__)
+    *mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    *mtime = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    *mtime = st.st_mtime * 1000000000LL;
+#endif
+    return 0;
+}
+
+static long tailCheckStart(long size) {
+    return size > WATCH_TAIL_CHECK ? size - WATCH_TAIL_CHECK : 0;
+}
+
+static int blockCount(size_t size) {
+    return (int) ((size + WATCH_BLOCK_SIZE - 1) / WATCH_BLOCK_SIZE);
+}
+
+static Uint64 frontHash(const char *data, size_t size, int block) {
+    size_t start = (size_t) block * WATCH_BLOCK_SIZE;
+    size_t length = size - start < WATCH_BLOCK_SIZE ? size - start : WATCH_BLOCK_SIZE;
+    return hashBytes(data + start, length);
+}
+
+static long backStart(size_t size, int block) {
+    long start = (long) size - (long) (block + 1) * WATCH_BLOCK_SIZE;
+    return start > 0 ? start : 0;
+}
+
+static Uint64 backHash(const char *data, size_t size, int block) {
+    long start = backStart(size, block);
+    long end = (long) size - (long) block * WATCH_BLOCK_SIZE;
+    return hashBytes(data + start, end - start);
+}
+
+static int buildSnapshot(FileWatch *watch, const char *data, size_t size) {
+    int count = blockCount(size);
+    WatchBlock *blocks = realloc(watch->blocks, (count + 1) * sizeof(WatchBlock));
+    if (blocks == nullptr) {
+        return -1;
+    }
+    watch->blocks = blocks;
+    watch->block_count = count;
+    watch->data_size = (long) size;
+
+    for (int b = 0; b < count; b++) {
+        blocks[b].front_hash = frontHash(data, size, b);
+        blocks[b].back_hash = backHash(data, size, b);
+        blocks[b].back_line = -1;
+        const char *newline = memchr(data + backStart(size, b), '\n', size - backStart(size, b));
+        blocks[b].back_start = newline ? newline - data + 1 : (long) size;
+    }
+
+    long pos = 0;
+    int line = 0;
+    int front = 0;
+    int back = count - 1;
+    long last_start = 0;
+    while (pos < (long) size) {
+        long end = segmentEnd(data, pos, size);
+        while (front < count && (long) front * WATCH_BLOCK_SIZE < end) {
+            blocks[front].front_line = line;
+            blocks[front].front_start = pos;
+            front++;
+        }
+        while (back >= 0 && blocks[back].back_start <= pos) {
+            if (blocks[back].back_start == pos) {
+                blocks[back].back_line = line;
+            }
+            back--;
+        }
+        last_start = pos;
+        pos = end;
+        line++;
+    }
+
+    SDL_bool open_tail = openTail(data, (long) size, last_start);
+    blocks[count].front_line = open_tail ? line - 1 : line;
+    blocks[count].front_start = open_tail ? last_start : (long) size;
+    for (int b = 0; b < count; b++) {
+        if (blocks[b].back_line < 0) {
+            blocks[b].back_line = line;
+            blocks[b].back_start = (long) size;
+        }
+    }
+    watch->line_count = line;
+    watch->stale = SDL_FALSE;
+    watch->tail_hash = hashBytes(data + tailCheckStart((long) size), (long) size - tailCheckStart((long) size));
+    return 0;
+}
+
+int initWatch(FileWatch *watch) {
+    memset(watch, 0, sizeof(*watch));
+    watch->fd = -1;
+    watch->wd = -1;
+    watch->event_type = SDL_RegisterEvents(1);
+    if (watch->event_type == (Uint32) -1) {
+        printf("Watch Error: %s\n", SDL_GetError());
+        return 1;
+    }
+#ifdef __linux__
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0) {
+        printf("Watch Error: inotify unavailable, falling back to polling.\n");
+    }
+#endif
+    return 0;
+}
+
+void unwatchFile(FileWatch *watch) {
+#ifdef __linux__
+    if (watch->wd >= 0) {
+        inotify_rm_watch(watch->fd, watch->wd);
+    }
+#endif
+    watch->wd = -1;
+    free(watch->path);
+    free(watch->blocks);
+    watch->path = nullptr;
+    watch->name = nullptr;
+    watch->blocks = nullptr;
+    watch->block_count = 0;
+    watch->pending = SDL_FALSE;
+}
+
+void destroyWatch(FileWatch *watch) {
+    unwatchFile(watch);
+#ifdef __linux__
+    if (watch->fd >= 0) {
+        close(watch->fd);
+    }
+#endif
+    watch->fd = -1;
+}
+
+int watchFile(FileWatch *watch, const char *path) {
+    char *copy = strdup(path);
+    if (copy == nullptr) {
+        return -1;
+    }
+    unwatchFile(watch);
+    watch->path = copy;
+    const char *slash = strrchr(copy, '/');
+    watch->name = slash ? slash + 1 : copy;
+
+    FileMap map;
+    if (readStamp(path, &watch->size, &watch->mtime) != 0 || mapFile(&map, path) != 0) {
+        unwatchFile(watch);
+        return -1;
+    }
+    int result = buildSnapshot(watch, map.data, map.size);
+    unmapFile(&map);
+    if (result != 0) {
+        unwatchFile(watch);
+        return -1;
+    }
+
+#ifdef __linux__
+    if (watch->fd >= 0) {
+        char *directory = strdup(path);
+        if (directory) {
+            char *dir_slash = strrchr(directory, '/');
+            if (dir_slash == directory) {
+                dir_slash[1] = '\0';
+            } else if (dir_slash) {
+                *dir_slash = '\0';
+            } else {
+                strcpy(directory, ".");
+            }
+            watch->wd = inotify_add_watch(watch->fd, directory,
+                                          IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB);
+            free(directory);
+        }
+    }
+#endif
+    return 0;
+}
+
+void pollWatch(FileWatch *watch) {
+    if (watch->path == nullptr) {
+        return;
+    }
+
+#ifdef __linux__
+    if (watch->wd >= 0) {
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+        while ((length = read(watch->fd, buffer, sizeof(buffer))) > 0) {
+            for (char *p = buffer; p < buffer + length;) {
+                struct inotify_event *event = (struct inotify_event *) p;
+                if (event->len > 0 && strcmp(event->name, watch->name) == 0) {
+                    watch->pending = SDL_TRUE;
+                }
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    } else {
+        watch->pending = SDL_TRUE;
+    }
+#else
+    watch->pending = SDL_TRUE;
+#endif
+
+    Uint64 now = SDL_GetTicks64();
+    if (!watch->pending || now - watch->last_poll < WATCH_INTERVAL_MS) {
+        return;
+    }
+    watch->last_poll = now;
+    watch->pending = SDL_FALSE;
+
+    long long size, mtime;
+    if (readStamp(watch->path, &size, &mtime) == 0 && (size != watch->size || mtime != watch->mtime)) {
+        watch->size = size;
+        watch->mtime = mtime;
+        SDL_Event event = {0};
+        event.type = watch->event_type;
+        SDL_PushEvent(&event);
+    }
+}
+
+static int parseSegments(const char *data, long start, long end, char ***lines_out, long *last_start) {
+    int capacity = 16;
+    int count = 0;
+    char **lines = malloc(capacity * sizeof(char *));
+    long pos = start;
+    *last_start = start;
+    while (lines && pos < end) {
+        if (count == capacity) {
+            char **grown = realloc(lines, capacity * 2 * sizeof(char *));
+            if (grown == nullptr) {
+                break;
+            }
+            lines = grown;
+            capacity *= 2;
+        }
+        char *line = allocLine();
+        if (line == nullptr) {
+            break;
+        }
+        long segment_end = segmentEnd(data, pos, end);
+        long length = segment_end - pos;
+        if (data[segment_end - 1] == '\n') {
+            length--;
+        }
+        memcpy(line, data + pos, length);
+        lines[count++] = line;
+        *last_start = pos;
+        pos = segment_end;
+    }
+
+    if (lines && pos < end) {
+        for (int i = 0; i < count; i++) {
+            freeLine(lines[i]);
+        }
+        free(lines);
+        lines = nullptr;
+    }
+    *lines_out = lines;
+    return count;
+}
+
+static void freeParsed(char **lines, int count) {
+    for (int i = 0; lines && i < count; i++) {
+        freeLine(lines[i]);
+    }
+    free(lines);
+}
+
+static int appendChanges(FileWatch *watch, Document *doc, ReloadRegion *region) {
+    WatchBlock *tail = &watch->blocks[watch->block_count];
+    long check_start = tailCheckStart(watch->data_size);
+    long start = tail->front_start < check_start ? tail->front_start : check_start;
+    long length = (long) watch->size - start;
+    FILE *file = fopen(watch->path, "rb");
+    char *data = file ? malloc(length > 0 ? length : 1) : nullptr;
+    if (data && fseek(file, start, SEEK_SET) == 0) {
+        length = (long) fread(data, 1, length, file);
+    } else {
+        length = -1;
+    }
+    if (file) {
+        fclose(file);
+    }
+    if (length < watch->data_size - start ||
+        hashBytes(data + check_start - start, watch->data_size - check_start) != watch->tail_hash) {
+        free(data);
+        return 1;
+    }
+
+    long tail_offset = tail->front_start - start;
+    long last_start;
+    char **lines = nullptr;
+    int count = parseSegments(data, tail_offset, length, &lines, &last_start);
+    int first_line = tail->front_line;
+    int removed = doc->line_count - first_line;
+    if (lines == nullptr || replaceLines(doc, first_line, removed, lines, count) != 0) {
+        printf("Watch Error: Could not reload %s\n", watch->path);
+        freeParsed(lines, count);
+        free(data);
+        return -1;
+    }
+    free(lines);
+
+    SDL_bool open_tail = openTail(data, length, last_start);
+    tail->front_start = start + (open_tail ? last_start : length);
+    tail->front_line = first_line + count - (open_tail ? 1 : 0);
+    watch->data_size = start + length;
+    watch->line_count = first_line + count;
+    watch->stale = SDL_TRUE;
+    check_start = tailCheckStart(watch->data_size);
+    watch->tail_hash = hashBytes(data + check_start - start, watch->data_size - check_start);
+    region->first_line = first_line;
+    region->removed = removed;
+    region->inserted = count;
+    if (doc->line_count == 0) {
+        insertLine(doc, 0);
+    }
+    free(data);
+    return 0;
+}
+
+int reloadChanges(FileWatch *watch, Document *doc, ReloadRegion *region) {
+    if (watch->path != nullptr && watch->follow && watch->size >= watch->data_size &&
+        (doc->line_count == watch->line_count || watch->line_count == 0)) {
+        int result = appendChanges(watch, doc, region);
+        if (result <= 0) {
+            return result;
+        }
+    }
+
+    FileMap map;
+    if (watch->path == nullptr || mapFile(&map, watch->path) != 0) {
+        return -1;
+    }
+
+    long old_size = watch->data_size;
+    long new_size = (long) map.size;
+    int old_blocks = watch->block_count;
+    int common = old_blocks < blockCount(map.size) ? old_blocks : blockCount(map.size);
+    if (watch->stale) {
+        common = 0;
+    }
+
+    int prefix = 0;
+    while (prefix < common && frontHash(map.data, map.size, prefix) == watch->blocks[prefix].front_hash) {
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < common && backHash(map.data, map.size, suffix) == watch->blocks[suffix].back_hash) {
+        suffix++;
+    }
+
+    int first_line = watch->blocks[prefix].front_line;
+    long first_start = watch->blocks[prefix].front_start;
+    while (suffix > 0 && (watch->blocks[suffix - 1].back_start < first_start ||
+                          watch->blocks[suffix - 1].back_start + new_size - old_size < first_start)) {
+        suffix--;
+    }
+    int old_end_line = suffix > 0 ? watch->blocks[suffix - 1].back_line : watch->line_count;
+    long new_end_start = suffix > 0 ? watch->blocks[suffix - 1].back_start + new_size - old_size : new_size;
+
+    if (!watch->stale && prefix == old_blocks && new_size == old_size) {
+        first_line = old_end_line = doc->line_count;
+        first_start = new_end_start = new_size;
+    } else if (watch->stale || doc->line_count != watch->line_count) {
+        first_line = 0;
+        first_start = 0;
+        old_end_line = doc->line_count;
+        new_end_start = new_size;
+    }
+
+    long last_start;
+    char **lines = nullptr;
+    int count = parseSegments(map.data, first_start, new_end_start, &lines, &last_start);
+    int result = 0;
+    if (lines == nullptr || replaceLines(doc, first_line, old_end_line - first_line, lines, count) != 0) {
+        freeParsed(lines, count);
+        lines = nullptr;
+        printf("Watch Error: Could not reload %s\n", watch->path);
+        result = -1;
+    } else {
+        region->first_line = first_line;
+        region->removed = old_end_line - first_line;
+        region->inserted = count;
+        if (doc->line_count == 0) {
+            insertLine(doc, 0);
+        }
+        result = buildSnapshot(watch, map.data, map.size);
+    }
+    free(lines);
+    unmapFile(&map);
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef TEXTEDITOR_WATCH_H
+#define TEXTEDITOR_WATCH_H
+
+#include <SDL.h>
+#include "document.h"
+
+#define WATCH_BLOCK_SIZE (64 * 1024)
+#define WATCH_INTERVAL_MS 100
+#define WATCH_TAIL_CHECK 4096
+
+typedef struct {
+    Uint64 front_hash;
+    Uint64 back_hash;
+    int front_line;
+    long front_start;
+    int back_line;
+    long back_start;
+} WatchBlock;
+
+typedef struct {
+    int first_line;
+    int removed;
+    int inserted;
+} ReloadRegion;
+
+typedef struct {
+    int fd;
+    int wd;
+    Uint32 event_type;
+    char *path;
+    const char *name;
+    long long size;
+    long long mtime;
+    SDL_bool pending;
+    Uint64 last_poll;
+    long data_size;
+    SDL_bool follow;
+    SDL_bool stale;
+    Uint64 tail_hash;
+    int block_count;
+    WatchBlock *blocks;
+    int line_count;
+} FileWatch;
+
+int initWatch(FileWatch *watch);
+
+void destroyWatch(FileWatch *watch);
+
+int watchFile(FileWatch *watch, const char *path);
+
+void unwatchFile(FileWatch *watch);
+
+void pollWatch(FileWatch *watch);
+
+int reloadChanges(FileWatch *watch, Document *doc, ReloadRegion *region);
+
+#endif